@@ -21,6 +21,8 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdint.h>
+#include <errno.h>
+#include <math.h>
 
 #ifdef _WIN32
     #include <windows.h>
@@ -28,32 +30,171 @@
     #define aligned_alloc(align, size) _aligned_malloc(size, align)
     #define aligned_free(ptr) _aligned_free(ptr)
 #else
-    #include <sys/time.h>
+    #include <time.h>
     #include <unistd.h>
     #define aligned_free(ptr) free(ptr)
     #ifdef __APPLE__
         #include <sys/sysctl.h>
     #endif
+    #ifdef __linux__
+        #include <dirent.h>
+        #include <fcntl.h>
+        #include <malloc.h>
+        #include <pthread.h>
+        #include <sched.h>
+        #include <sys/ioctl.h>
+        #include <sys/mman.h>
+        #include <sys/prctl.h>
+        #include <sys/resource.h>
+        #include <sys/socket.h>
+        #include <sys/stat.h>
+        #include <sys/syscall.h>
+        #include <sys/uio.h>
+        #include <sys/wait.h>
+        #include <linux/fs.h>
+        #include <linux/io_uring.h>
+    #endif
 #endif
 
 #include <omp.h>
 
 #ifndef NTIMES
-#define NTIMES 20
+#define NTIMES 20               // Default for --iters
 #endif
 
 #define ALIGN 64
+#define PAGE_ALIGN 4096         // Kernel arrays, so page-sized schedule chunks are whole pages
+#define MAX_CPUS 1024
 
 // Cache info structure
 typedef struct {
     size_t l1d_size;    // L1 data cache (per core)
     size_t l1i_size;    // L1 instruction cache (per core)
     size_t l2_size;     // L2 cache (per core or shared)
-    size_t l3_size;     // L3 cache (usually shared)
+    size_t l3_size;     // L3 cache (usually shared), per instance
+    int l3_domains;     // Distinct L3 instances (CCX / sub-NUMA cluster), 0 if unknown
     size_t line_size;   // Cache line size
     int num_cores;      // Number of physical cores
 } cache_info_t;
 
+// Run modes selected with --mode
+typedef enum {
+    MODE_BENCH = 0,     // Default: timed reads:writes kernel
+    MODE_IOURING,       // Storage -> memory streaming via io_uring + O_DIRECT
+    MODE_IPC,           // Pipe / splice / socket bandwidth between two processes
+    MODE_RING,          // Shared-memory SPSC / MPMC ring throughput and latency
+    MODE_PVM,           // process_vm_readv / process_vm_writev from a child
+    MODE_MAGICRING,     // Double-mapped memfd ring vs split-copy ring
+    MODE_THREAD_SWEEP,  // Patterns at 1..N threads with saturation knee
+    MODE_SIZE_SWEEP,    // Bandwidth and latency from 4 KB to past the LLC
+    MODE_SMT,           // One thread per core vs packed onto SMT siblings
+    MODE_HYBRID,        // P-core / E-core bandwidth and weighted partitioning
+    MODE_SCHEDULE,      // static / dynamic / guided / stealing, quiet vs interfered
+    MODE_FORKJOIN,      // parallel / barrier / for / spin barrier overhead
+    MODE_L3DOMAINS,     // Bandwidth per L3 domain and scaling across domains
+    MODE_INTERFERE,     // Victim bandwidth/latency vs aggressor thread count
+    MODE_LOADGEN,       // Rate-limited background load (--rate, --duration)
+    MODE_LOWNOISE,      // SCHED_FIFO, mlockall, isolated CPUs vs a default run
+} run_mode_t;
+
+// Thread placement policies for --bind
+typedef enum {
+    BIND_NONE = 0,      // Leave placement to the OpenMP runtime and OS
+    BIND_COMPACT,       // Consecutive logical CPUs, SMT siblings first
+    BIND_SCATTER,       // Round-robin across L3 domains and packages
+    BIND_CORE,          // One thread per physical core
+    BIND_LIST,          // Explicit CPU list
+} bind_policy_t;
+
+// Threading backend for the timed kernel
+typedef enum {
+    BACKEND_OMP = 0,    // omp parallel for per iteration (default)
+    BACKEND_PTHREAD,    // Persistent pinned pthread team with spin barriers
+} backend_t;
+
+// Clock behind get_time_sec (--timer)
+typedef enum {
+    TIMER_CLOCK = 0,    // CLOCK_MONOTONIC_RAW (QueryPerformanceCounter on Windows)
+    TIMER_TSC,          // Invariant TSC via RDTSCP, calibrated at startup
+} timer_kind_t;
+
+// Loop schedule for the timed kernel (--schedule)
+typedef enum {
+    SCHED_STATIC = 0,   // schedule(static), the default
+    SCHED_DYNAMIC,      // schedule(dynamic, chunk)
+    SCHED_GUIDED,       // schedule(guided, chunk)
+    SCHED_STEAL,        // Work stealing over page-aligned chunks
+} sched_kind_t;
+
+typedef enum {
+    RING_SPSC = 0,
+    RING_MPMC,
+    RING_BOTH,
+} ring_kind_t;
+
+// Command-line options (everything after the positional arguments)
+typedef struct {
+    run_mode_t mode;
+    const char *file;       // --file: input file for storage modes
+    int queue_depth;        // --qd: io_uring submission queue depth
+    size_t block_size;      // --bs: bytes per I/O request
+    int fixed_buffers;      // --fixed: register buffers with io_uring
+    int pipeline;           // --pipeline: overlap I/O with the 1:0 kernel
+    ring_kind_t ring_kind;  // --ring: spsc, mpmc or both
+    int ring_procs;         // --procs: ring workers are processes, not threads
+    bind_policy_t bind;     // --bind: thread placement policy
+    const char *bind_list;  // --bind=LIST: explicit CPUs
+    backend_t backend;      // --backend: omp or pthread
+    int per_thread;         // --per-thread: time and report every thread's slice
+    int noise;              // --noise: sample IRQs, switches and migrations per iteration
+    const char *patterns;   // --patterns: comma-separated reads:writes list
+    int sweep_linear;       // --steps=linear: every thread count, not powers of two
+    sched_kind_t schedule;  // --schedule: loop schedule of the timed kernel
+    size_t chunk_bytes;     // --schedule=KIND:CHUNK: bytes per chunk
+    const char *victim;     // --victim: interfere victim patterns and/or "latency"
+    double rate_gbs;        // --rate: loadgen target in GB/s, 0 = unlimited
+    double duration;        // --duration: seconds to run, 0 = mode default
+    timer_kind_t timer;     // --timer: clock or tsc
+    int force;              // --force: report results too short for the timer
+    int iters;              // --iters: timed iterations, the first is warm-up
+    double adaptive_ci;     // --adaptive: stop at this relative median CI, 0 = off
+    double budget;          // --budget: adaptive time limit in seconds
+    const char *csv;        // --csv: size-sweep results file
+    int probe_cache;        // --probe-cache: measure cache sizes from latency knees
+    int auto_empirical;     // --auto-size=empirical: size from the measured caches
+} options_t;
+
+static options_t opts = {
+    .mode = MODE_BENCH,
+    .file = NULL,
+    .queue_depth = 32,
+    .block_size = 1024 * 1024,
+    .fixed_buffers = 0,
+    .pipeline = 0,
+    .ring_kind = RING_BOTH,
+    .ring_procs = 0,
+    .bind = BIND_NONE,
+    .bind_list = NULL,
+    .backend = BACKEND_OMP,
+    .per_thread = 0,
+    .noise = 0,
+    .patterns = NULL,
+    .sweep_linear = 0,
+    .schedule = SCHED_STATIC,
+    .chunk_bytes = 64 * 1024,
+    .victim = NULL,
+    .rate_gbs = 0.0,
+    .duration = 0.0,
+    .timer = TIMER_CLOCK,
+    .force = 0,
+    .iters = NTIMES,
+    .adaptive_ci = 0.0,
+    .budget = 30.0,
+    .csv = NULL,
+    .probe_cache = 0,
+    .auto_empirical = 0,
+};
+
 static double *restrict a = NULL;
 static double *restrict b = NULL;
 static double *restrict c = NULL;
@@ -62,19 +203,78 @@ static double *restrict c = NULL;
 // Cross-platform timing
 // ============================================================================
 
-static inline double get_time_sec(void) {
+// Monotonic clock that NTP cannot step or slew
+static inline double clock_sec(void) {
 #ifdef _WIN32
     LARGE_INTEGER freq, counter;
     QueryPerformanceFrequency(&freq);
     QueryPerformanceCounter(&counter);
     return (double)counter.QuadPart / (double)freq.QuadPart;
 #else
-    struct timeval tv;
-    gettimeofday(&tv, NULL);
-    return tv.tv_sec + tv.tv_usec * 1e-6;
+    struct timespec ts;
+#if defined(CLOCK_MONOTONIC_RAW)
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+#else
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+#endif
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+#endif
+}
+
+// Raw cycle counter for cheap timestamps that are comparable across threads
+// and processes (invariant TSC on x86, virtual counter on AArch64)
+static inline uint64_t tsc_now(void) {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    return __rdtsc();
+#elif defined(__x86_64__) || defined(__i386__)
+    return __builtin_ia32_rdtsc();
+#elif defined(__aarch64__)
+    uint64_t v;
+    __asm__ volatile("mrs %0, cntvct_el0" : "=r"(v));
+    return v;
+#else
+    return (uint64_t)(clock_sec() * 1e9);
+#endif
+}
+
+// Like tsc_now, but waits for earlier instructions to finish (RDTSCP), so the
+// kernel being timed cannot drift past the closing timestamp
+static inline uint64_t tscp_now(void) {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    unsigned aux;
+    return __rdtscp(&aux);
+#elif defined(__x86_64__) || defined(__i386__)
+    unsigned aux;
+    return __builtin_ia32_rdtscp(&aux);
+#elif defined(__aarch64__)
+    uint64_t v;
+    __asm__ volatile("isb; mrs %0, cntvct_el0" : "=r"(v) :: "memory");
+    return v;
+#else
+    return tsc_now();
 #endif
 }
 
+// Counter ticks per second, calibrated once against the monotonic clock
+static double tsc_ticks_per_sec(void) {
+    static double rate = 0.0;
+    if (rate == 0.0) {
+        double t0 = clock_sec();
+        uint64_t c0 = tsc_now();
+        while (clock_sec() - t0 < 0.05) { }
+        double t1 = clock_sec();
+        uint64_t c1 = tsc_now();
+        rate = (double)(c1 - c0) / (t1 - t0);
+    }
+    return rate;
+}
+
+// Timestamp for timed regions: --timer=clock (default) or --timer=tsc
+static inline double get_time_sec(void) {
+    if (opts.timer == TIMER_TSC) return (double)tscp_now() / tsc_ticks_per_sec();
+    return clock_sec();
+}
+
 // ============================================================================
 // Cross-platform cache detection
 // ============================================================================
@@ -163,6 +363,57 @@ static size_t read_cache_size(const char *path) {
     return 0;
 }
 
+static int read_int_file(const char *path, int *out) {
+    FILE *f = fopen(path, "r");
+    if (!f) return -1;
+    int ok = fscanf(f, "%d", out) == 1;
+    fclose(f);
+    return ok ? 0 : -1;
+}
+
+// Parse a sysfs-style CPU list ("0-3,8,10-11"); returns the count stored
+static int parse_cpu_list(const char *s, int *out, int max) {
+    int n = 0;
+    while (*s && n < max) {
+        char *end;
+        long lo = strtol(s, &end, 10);
+        if (end == s) break;
+        long hi = lo;
+        s = end;
+        if (*s == '-') {
+            hi = strtol(s + 1, &end, 10);
+            if (end == s + 1) break;
+            s = end;
+        }
+        for (long c = lo; c <= hi && n < max; c++) out[n++] = (int)c;
+        while (*s == ',' || *s == ' ' || *s == '\n') s++;
+    }
+    return n;
+}
+
+static int read_cpu_list_file(const char *path, int *out, int max) {
+    char buf[4096];
+    FILE *f = fopen(path, "r");
+    if (!f) return 0;
+    int n = fgets(buf, sizeof(buf), f) ? parse_cpu_list(buf, out, max) : 0;
+    fclose(f);
+    return n;
+}
+
+// Lowest CPU sharing this CPU's L3 (identifies the L3 domain), or -1
+static int l3_leader(int cpu) {
+    char path[256];
+    for (int i = 0; i < 10; i++) {
+        int level, shared[1];
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cache/index%d/level", cpu, i);
+        if (read_int_file(path, &level) != 0) break;
+        if (level != 3) continue;
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cache/index%d/shared_cpu_list", cpu, i);
+        return read_cpu_list_file(path, shared, 1) == 1 ? shared[0] : -1;
+    }
+    return -1;
+}
+
 static void detect_cache_linux(cache_info_t *info) {
     // Try sysfs first (more reliable)
     const char *base = "/sys/devices/system/cpu/cpu0/cache";
@@ -202,32 +453,27 @@ static void detect_cache_linux(cache_info_t *info) {
         } else if (level == 2) {
             info->l2_size = size;
         } else if (level == 3) {
-            // L3 is often shared - try to get total size
-            snprintf(path, sizeof(path), "%s/index%d/shared_cpu_list", base, i);
-            f = fopen(path, "r");
-            if (f) {
-                char shared[256];
-                if (fgets(shared, sizeof(shared), f)) {
-                    // Count how many CPUs share this cache
-                    int count = 1;
-                    for (char *p = shared; *p; p++) if (*p == ',' || *p == '-') count++;
-                    // If it's a range (0-95), calculate properly
-                    int start, end;
-                    if (sscanf(shared, "%d-%d", &start, &end) == 2) {
-                        info->l3_size = size;  // This is the total shared L3
-                    } else {
-                        info->l3_size = size;
-                    }
-                }
-                fclose(f);
-            } else {
-                info->l3_size = size;
-            }
+            info->l3_size = size;
         }
     }
     
-    // Get number of cores
-    FILE *f = fopen("/proc/cpuinfo", "r");
+    // cpu0 only shows its own L3; chiplet parts have one per CCX. Count the
+    // domains as CPUs that lead their L3 shared_cpu_list.
+    long ncpus = sysconf(_SC_NPROCESSORS_CONF);
+    for (long cpu = 0; cpu < ncpus && cpu < MAX_CPUS; cpu++) {
+        if (l3_leader((int)cpu) == cpu) info->l3_domains++;
+    }
+    
+    // Count physical cores: one per distinct thread_siblings_list, identified
+    // by its lowest CPU. Unlike max(core id) this is right on multi-socket hosts.
+    for (long cpu = 0; cpu < ncpus && cpu < MAX_CPUS; cpu++) {
+        int siblings[1];
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%ld/topology/thread_siblings_list", cpu);
+        if (read_cpu_list_file(path, siblings, 1) == 1 && siblings[0] == cpu) info->num_cores++;
+    }
+    
+    // Fallback: highest core id in /proc/cpuinfo
+    FILE *f = info->num_cores == 0 ? fopen("/proc/cpuinfo", "r") : NULL;
     if (f) {
         char line[256];
         int max_core_id = -1;
@@ -295,6 +541,67 @@ static void detect_cache_cpuid(cache_info_t *info) {
 }
 #endif
 
+// ============================================================================
+// Timer selection: invariant TSC check, resolution and overhead
+// ============================================================================
+
+#define TIMER_MIN_STEPS 100     // Refuse results shorter than this many resolutions
+
+static double timer_resolution;     // Smallest non-zero step between reads, seconds
+static double timer_overhead;       // Cost of one get_time_sec() call, seconds
+
+// Constant-rate counter that keeps ticking in every P- and C-state
+static int tsc_invariant(void) {
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+    uint32_t eax, ebx, ecx, edx;
+    cpuid(0x80000000, 0, &eax, &ebx, &ecx, &edx);
+    if (eax < 0x80000007) return 0;
+    cpuid(0x80000007, 0, &eax, &ebx, &ecx, &edx);
+    return (edx >> 8) & 1;
+#elif defined(__aarch64__)
+    return 1;   // The generic timer runs at a fixed frequency by definition
+#else
+    return 0;
+#endif
+}
+
+static const char *timer_name(void) {
+    if (opts.timer == TIMER_TSC) return "TSC (RDTSCP)";
+#ifdef _WIN32
+    return "QueryPerformanceCounter";
+#elif defined(CLOCK_MONOTONIC_RAW)
+    return "CLOCK_MONOTONIC_RAW";
+#else
+    return "CLOCK_MONOTONIC";
+#endif
+}
+
+// Calibrate the selected timer and measure its resolution and call overhead;
+// returns -1 if it cannot be used
+static int timer_init(void) {
+    if (opts.timer == TIMER_TSC) {
+        if (!tsc_invariant()) {
+            fprintf(stderr, "Error: --timer=tsc needs an invariant TSC, which this CPU does not report\n");
+            return -1;
+        }
+        tsc_ticks_per_sec();
+    }
+
+    timer_resolution = 1.0;
+    for (int i = 0; i < 1000; i++) {
+        double t0 = get_time_sec(), t1;
+        while ((t1 = get_time_sec()) == t0) { }
+        if (t1 - t0 < timer_resolution) timer_resolution = t1 - t0;
+    }
+
+    const int calls = 100000;
+    double sink = 0.0, t0 = get_time_sec();
+    for (int i = 0; i < calls; i++) sink += get_time_sec();
+    timer_overhead = (get_time_sec() - t0) / calls;
+    if (sink < 0.0) printf("%f", sink);
+    return 0;
+}
+
 // Main cache detection function
 static cache_info_t detect_cache_info(void) {
     cache_info_t info = {0};
@@ -324,6 +631,11 @@ static cache_info_t detect_cache_info(void) {
     return info;
 }
 
+// All L3 instances together: what arrays must exceed to stream from DRAM
+static size_t cache_l3_total(const cache_info_t *info) {
+    return info->l3_size * (size_t)(info->l3_domains > 1 ? info->l3_domains : 1);
+}
+
 static void print_cache_info(cache_info_t *info) {
     printf("════════════════════════════════════════════════════════════\n");
     printf("  Cache Hierarchy Detected\n");
@@ -336,11 +648,354 @@ static void print_cache_info(cache_info_t *info) {
     } else {
         printf("  L3 Cache:     %7zu KB (shared)\n", info->l3_size / 1024);
     }
+    if (info->l3_domains > 1) {
+        printf("  L3 Domains:   %7d (%zu MB total)\n", info->l3_domains,
+               cache_l3_total(info) / (1024 * 1024));
+    }
     printf("  Cache Line:   %7zu bytes\n", info->line_size);
     printf("  Physical Cores: %5d\n", info->num_cores);
     printf("════════════════════════════════════════════════════════════\n\n");
 }
 
+// ============================================================================
+// CPU topology and pinning (Linux sysfs)
+// ============================================================================
+
+#if defined(__linux__)
+typedef struct {
+    int cpu;        // Logical CPU number
+    int package;    // physical_package_id
+    int core;       // core_id (unique within a package)
+    int l3;         // L3 domain: lowest CPU in the L3's shared_cpu_list
+    int node;       // NUMA node
+    int smt_leader; // Lowest CPU in thread_siblings_list (identifies the core)
+    int smt_width;  // Hardware threads on this core
+    int capacity;   // cpu_capacity (1024 = fastest core), 0 if not exposed
+    int core_class; // Index into topology_t.class_names
+} cpu_topo_t;
+
+#define MAX_CORE_CLASSES 8
+
+typedef struct {
+    int num_cpus;                   // CPUs in our affinity mask
+    cpu_topo_t cpus[MAX_CPUS];      // Sorted by logical CPU number
+    int num_classes;                // Core types (P/E, or distinct capacities)
+    char class_names[MAX_CORE_CLASSES][16];
+    const char *class_source;       // Where the classes came from
+} topology_t;
+
+static topology_t topo;
+
+// Hybrid CPUs: Intel exposes separate PMUs listing P-cores (cpu_core) and
+// E-cores (cpu_atom); Arm big.LITTLE exposes per-CPU cpu_capacity instead
+static void detect_core_classes(void) {
+    int list[MAX_CPUS], n;
+    char path[128];
+
+    topo.num_classes = 1;
+    snprintf(topo.class_names[0], sizeof(topo.class_names[0]), "uniform");
+    topo.class_source = "none (homogeneous)";
+
+    for (int i = 0; i < topo.num_cpus; i++) {
+        cpu_topo_t *t = &topo.cpus[i];
+        t->core_class = 0;
+        t->capacity = 0;
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cpu_capacity", t->cpu);
+        read_int_file(path, &t->capacity);
+    }
+
+    static const char *pmu_classes[2][2] = {
+        { "/sys/devices/cpu_core/cpus", "P-core" },
+        { "/sys/devices/cpu_atom/cpus", "E-core" },
+    };
+    // Collected aside and committed only when both PMUs are present; one list
+    // alone would leave class 1 set on CPUs of a single-class topology
+    int pmu_class[MAX_CPUS] = {0}, found = 0;
+    for (int k = 0; k < 2; k++) {
+        n = read_cpu_list_file(pmu_classes[k][0], list, MAX_CPUS);
+        if (n == 0) continue;
+        found++;
+        for (int j = 0; j < n; j++) {
+            for (int i = 0; i < topo.num_cpus; i++) {
+                if (topo.cpus[i].cpu == list[j]) pmu_class[i] = k;
+            }
+        }
+    }
+    if (found == 2) {
+        for (int i = 0; i < topo.num_cpus; i++) topo.cpus[i].core_class = pmu_class[i];
+        topo.num_classes = 2;
+        snprintf(topo.class_names[0], sizeof(topo.class_names[0]), "%s", pmu_classes[0][1]);
+        snprintf(topo.class_names[1], sizeof(topo.class_names[1]), "%s", pmu_classes[1][1]);
+        topo.class_source = "/sys/devices/cpu_{core,atom}/cpus";
+        return;
+    }
+
+    // Fallback: one class per distinct cpu_capacity, highest first
+    int caps[MAX_CORE_CLASSES], ncaps = 0;
+    for (int i = 0; i < topo.num_cpus; i++) {
+        int cap = topo.cpus[i].capacity, k;
+        if (cap <= 0) return;
+        for (k = 0; k < ncaps && caps[k] != cap; k++) { }
+        if (k == ncaps && ncaps < MAX_CORE_CLASSES) caps[ncaps++] = cap;
+    }
+    if (ncaps < 2) return;
+    for (int x = 0; x < ncaps; x++) {
+        for (int y = x + 1; y < ncaps; y++) {
+            if (caps[y] > caps[x]) { int tmp = caps[x]; caps[x] = caps[y]; caps[y] = tmp; }
+        }
+    }
+    topo.num_classes = ncaps;
+    for (int k = 0; k < ncaps; k++) {
+        snprintf(topo.class_names[k], sizeof(topo.class_names[k]), "cap %d", caps[k]);
+    }
+    for (int i = 0; i < topo.num_cpus; i++) {
+        for (int k = 0; k < ncaps; k++) {
+            if (topo.cpus[i].capacity == caps[k]) topo.cpus[i].core_class = k;
+        }
+    }
+    topo.class_source = "cpu_capacity";
+}
+
+// Fill topo from sysfs for every CPU we are allowed to run on
+static void detect_topology(void) {
+    cpu_set_t set;
+    char path[256];
+
+    topo.num_cpus = 0;
+    if (sched_getaffinity(0, sizeof(set), &set) != 0) return;
+
+    for (int cpu = 0; cpu < CPU_SETSIZE && topo.num_cpus < MAX_CPUS; cpu++) {
+        if (!CPU_ISSET(cpu, &set)) continue;
+        cpu_topo_t *t = &topo.cpus[topo.num_cpus++];
+        t->cpu = cpu;
+        t->package = 0;
+        t->core = cpu;
+        t->node = 0;
+
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/physical_package_id", cpu);
+        read_int_file(path, &t->package);
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/core_id", cpu);
+        read_int_file(path, &t->core);
+
+        int siblings[MAX_CPUS];
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/thread_siblings_list", cpu);
+        t->smt_width = read_cpu_list_file(path, siblings, MAX_CPUS);
+        t->smt_leader = t->smt_width > 0 ? siblings[0] : cpu;
+        if (t->smt_width == 0) t->smt_width = 1;
+
+        // Without cache info, treat each package as one L3 domain
+        t->l3 = l3_leader(cpu);
+        if (t->l3 < 0) t->l3 = -1 - t->package;
+    }
+
+    detect_core_classes();
+
+    int nodes[MAX_CPUS], cpus[MAX_CPUS];
+    int num_nodes = read_cpu_list_file("/sys/devices/system/node/online", nodes, MAX_CPUS);
+    for (int i = 0; i < num_nodes; i++) {
+        snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", nodes[i]);
+        int n = read_cpu_list_file(path, cpus, MAX_CPUS);
+        for (int j = 0; j < n; j++) {
+            for (int k = 0; k < topo.num_cpus; k++) {
+                if (topo.cpus[k].cpu == cpus[j]) topo.cpus[k].node = nodes[i];
+            }
+        }
+    }
+}
+
+// Order by package, then core (SMT siblings adjacent), then CPU
+static int topo_cmp_compact(const void *x, const void *y) {
+    const cpu_topo_t *p = (const cpu_topo_t *)x, *q = (const cpu_topo_t *)y;
+    if (p->package != q->package) return p->package - q->package;
+    if (p->smt_leader != q->smt_leader) return p->smt_leader - q->smt_leader;
+    return p->cpu - q->cpu;
+}
+
+// All CPUs ordered one per physical core, filling a package before moving
+// on, followed by the remaining SMT siblings. Returns the count.
+static int topology_core_order(int *order) {
+    if (topo.num_cpus == 0) detect_topology();
+
+    cpu_topo_t sorted[MAX_CPUS];
+    unsigned char used[MAX_CPUS] = {0};
+    memcpy(sorted, topo.cpus, topo.num_cpus * sizeof(cpu_topo_t));
+    qsort(sorted, topo.num_cpus, sizeof(cpu_topo_t), topo_cmp_compact);
+
+    int count = 0;
+    for (int i = 0; i < topo.num_cpus; i++) {
+        // First CPU of each physical core
+        if (i == 0 || sorted[i].smt_leader != sorted[i - 1].smt_leader) {
+            order[count++] = sorted[i].cpu;
+            used[i] = 1;
+        }
+    }
+    for (int i = 0; i < topo.num_cpus; i++) {
+        if (!used[i]) order[count++] = sorted[i].cpu;
+    }
+    return count;
+}
+
+static const cpu_topo_t *topology_find(int cpu) {
+    for (int i = 0; i < topo.num_cpus; i++) {
+        if (topo.cpus[i].cpu == cpu) return &topo.cpus[i];
+    }
+    return NULL;
+}
+
+// Pick n CPUs in topology_core_order, wrapping around if n is larger
+static int topology_pick_cpus(int n, int *out) {
+    int order[MAX_CPUS];
+    int count = topology_core_order(order);
+    if (count == 0) return 0;
+
+    for (int i = 0; i < n; i++) out[i] = order[i % count];
+    return n;
+}
+
+// Distinct L3 domains in core order; returns the count
+static int topology_l3_domains(int *domains) {
+    int order[MAX_CPUS], n = 0;
+    int total = topology_core_order(order);
+    for (int i = 0; i < total; i++) {
+        int l3 = topology_find(order[i])->l3, d;
+        for (d = 0; d < n && domains[d] != l3; d++) { }
+        if (d == n) domains[n++] = l3;
+    }
+    return n;
+}
+
+// CPUs sharing one L3 domain, in core order; returns the count
+static int topology_domain_cpus(int l3, int *out) {
+    int order[MAX_CPUS], n = 0;
+    int total = topology_core_order(order);
+    for (int i = 0; i < total; i++) {
+        if (topology_find(order[i])->l3 == l3) out[n++] = order[i];
+    }
+    return n;
+}
+
+// Spin politely; yield now and then so oversubscribed runs still progress
+static inline void spin_relax(unsigned *spins) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ volatile("yield");
+#endif
+    if (++*spins % 1024 == 0) sched_yield();
+}
+
+// Pin the calling thread (or process) to one CPU
+static void pin_to_cpu(int cpu) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    sched_setaffinity(0, sizeof(set), &set);
+}
+
+// CPU for each of n threads under the given --bind policy. Returns 0 when
+// threads should stay unpinned, -1 on error.
+static int binding_plan(bind_policy_t policy, const char *list, int n, int *out) {
+    int order[MAX_CPUS];
+    int count = 0;
+
+    if (topo.num_cpus == 0) detect_topology();
+
+    switch (policy) {
+    case BIND_NONE:
+        return 0;
+    case BIND_COMPACT: {
+        // Logical neighbours: fill every SMT sibling of a core before the next core
+        cpu_topo_t sorted[MAX_CPUS];
+        memcpy(sorted, topo.cpus, topo.num_cpus * sizeof(cpu_topo_t));
+        qsort(sorted, topo.num_cpus, sizeof(cpu_topo_t), topo_cmp_compact);
+        for (int i = 0; i < topo.num_cpus; i++) order[count++] = sorted[i].cpu;
+        break;
+    }
+    case BIND_CORE:
+        count = topology_core_order(order);
+        break;
+    case BIND_SCATTER: {
+        // Round-robin over L3 domains (which also spreads across packages),
+        // taking each domain's CPUs in core order
+        int core_order[MAX_CPUS], domains[MAX_CPUS];
+        unsigned char used[MAX_CPUS] = {0};
+        int total = topology_core_order(core_order);
+        int ndomains = topology_l3_domains(domains);
+        while (count < total) {
+            for (int d = 0; d < ndomains; d++) {
+                for (int i = 0; i < total; i++) {
+                    if (!used[i] && topology_find(core_order[i])->l3 == domains[d]) {
+                        used[i] = 1;
+                        order[count++] = core_order[i];
+                        break;
+                    }
+                }
+            }
+        }
+        break;
+    }
+    case BIND_LIST:
+        count = parse_cpu_list(list, order, MAX_CPUS);
+        for (int i = 0; i < count; i++) {
+            if (!topology_find(order[i])) {
+                fprintf(stderr, "Error: CPU %d in --bind list is not available\n", order[i]);
+                return -1;
+            }
+        }
+        break;
+    }
+
+    if (count == 0) {
+        fprintf(stderr, "Error: no CPUs available for --bind\n");
+        return -1;
+    }
+    for (int i = 0; i < n; i++) out[i] = order[i % count];
+    return 1;
+}
+
+// Pin each thread of an OpenMP team of num_threads under a policy.
+// The runtime reuses its threads, so the pinning holds for later regions.
+static void pin_team(const int *plan, int num_threads) {
+    #pragma omp parallel num_threads(num_threads)
+    pin_to_cpu(plan[omp_get_thread_num()]);
+}
+
+static int bind_team(bind_policy_t policy, const char *list, int num_threads) {
+    int plan[MAX_CPUS];
+    int ret = binding_plan(policy, list, num_threads, plan);
+    if (ret <= 0) return ret;
+
+    pin_team(plan, num_threads);
+    return 0;
+}
+
+// Pin the team according to --bind
+static int apply_binding(int num_threads) {
+    return bind_team(opts.bind, opts.bind_list, num_threads);
+}
+
+// Record the CPU each thread of the team is on; counts changes in moved[]
+static void sample_thread_cpus(int num_threads, int *cpus, int *moved) {
+    #pragma omp parallel num_threads(num_threads)
+    {
+        int tid = omp_get_thread_num();
+        int cpu = sched_getcpu();
+        if (moved && cpus[tid] >= 0 && cpus[tid] != cpu) moved[tid]++;
+        cpus[tid] = cpu;
+    }
+}
+#endif
+
+static const char *bind_policy_name(bind_policy_t policy) {
+    switch (policy) {
+    case BIND_COMPACT: return "compact";
+    case BIND_SCATTER: return "scatter";
+    case BIND_CORE:    return "core";
+    case BIND_LIST:    return "list";
+    default:           return "none";
+    }
+}
+
 // ============================================================================
 // Memory allocation (cross-platform)
 // ============================================================================
@@ -359,13 +1014,16 @@ static void *alloc_aligned(size_t alignment, size_t size) {
 // Generic benchmark kernel - supports ANY reads:writes pattern
 // ============================================================================
 
-static double kernel_generic(size_t n, int reads, int writes) {
+// Any reads:writes pattern over caller-supplied arrays, so independent
+// thread groups (see --mode=interfere) can stream side by side
+static double kernel_arrays(double *restrict x, double *restrict y, double *restrict z,
+                            size_t n, int reads, int writes) {
     double sum = 0.0;
-    double *arrays[3] = {a, b, c};
+    double *arrays[3] = {x, y, z};
     
     // Special case: read-only (needs reduction)
     if (writes == 0 && reads > 0) {
-        #pragma omp parallel for simd reduction(+:sum) aligned(a, b, c: ALIGN) schedule(static)
+        #pragma omp parallel for simd reduction(+:sum) aligned(x, y, z: ALIGN) schedule(static)
         for (size_t i = 0; i < n; i++) {
             double tmp = 0.0;
             for (int r = 0; r < reads; r++) {
@@ -377,7 +1035,7 @@ static double kernel_generic(size_t n, int reads, int writes) {
     }
     
     // General case: any combination of reads and writes
-    #pragma omp parallel for simd aligned(a, b, c: ALIGN) schedule(static)
+    #pragma omp parallel for simd aligned(x, y, z: ALIGN) schedule(static)
     for (size_t i = 0; i < n; i++) {
         // Perform reads
         double tmp = 0.0;
@@ -394,131 +1052,4574 @@ static double kernel_generic(size_t n, int reads, int writes) {
     return sum;
 }
 
-#define MIN(x,y) ((x)<(y)?(x):(y))
-#define MAX(x,y) ((x)>(y)?(x):(y))
+// The pattern over the benchmark's global arrays
+static double kernel_generic(size_t n, int reads, int writes) {
+    return kernel_arrays(a, b, c, n, reads, writes);
+}
 
-// ============================================================================
-// Main benchmark
-// ============================================================================
+// Thread tid's static slice of n elements, split on cache-line boundaries
+static void thread_slice(int tid, int nt, size_t n, size_t *lo, size_t *hi) {
+    *lo = (n * tid / nt) & ~(size_t)7;
+    *hi = tid == nt - 1 ? n : (n * (tid + 1) / nt) & ~(size_t)7;
+}
 
-void run_benchmark(int num_threads, size_t array_size, cache_info_t *cache, int reads, int writes) {
-    omp_set_num_threads(num_threads);
-    
-    // Allocate aligned memory
-    a = (double *)alloc_aligned(ALIGN, array_size * sizeof(double));
-    b = (double *)alloc_aligned(ALIGN, array_size * sizeof(double));
-    c = (double *)alloc_aligned(ALIGN, array_size * sizeof(double));
+// Single-thread kernel over [lo, hi); used where each thread owns a static
+// slice (pthread backend, per-thread timing)
+static double kernel_slice(size_t lo, size_t hi, int reads, int writes) {
+    double sum = 0.0;
+    double *arrays[3] = {a, b, c};
     
-    if (!a || !b || !c) {
-        fprintf(stderr, "Memory allocation failed\n");
-        exit(1);
+    if (writes == 0 && reads > 0) {
+        #pragma omp simd reduction(+:sum)
+        for (size_t i = lo; i < hi; i++) {
+            double tmp = 0.0;
+            for (int r = 0; r < reads; r++) {
+                tmp += arrays[r % 3][i];
+            }
+            sum += tmp;
+        }
+        return sum;
     }
     
-    double mem_per_array = (double)(array_size * sizeof(double)) / (1024.0 * 1024.0);
-    double total_mem = mem_per_array * 3;
-    double l3_mb = (double)cache->l3_size / (1024.0 * 1024.0);
-    
-    // Calculate actual DRAM bytes (not logical operations)
-    // With only 3 arrays, max unique accesses per element is 3 reads + 3 writes
-    // Additional reads/writes hit L1 cache and don't contribute to DRAM bandwidth
-    int actual_reads = MIN(reads, 3);
-    int actual_writes = MIN(writes, 3);
-    double bytes_per_elem = (double)(actual_reads + actual_writes) * sizeof(double);
-    double total_bytes = bytes_per_elem * array_size;
-    
-    printf("════════════════════════════════════════════════════════════\n");
-    printf("  UltraMem - Memory Bandwidth Benchmark\n");
-    printf("════════════════════════════════════════════════════════════\n");
-    printf("  Kernel pattern:    %d:%d (%d reads + %d writes)\n", reads, writes, reads, writes);
-    if (reads > 3 || writes > 3) {
-        printf("  DRAM accesses:     %d:%d (extra ops hit L1 cache)\n", actual_reads, actual_writes);
-    }
-    printf("  Threads:           %d\n", num_threads);
-    printf("  Array elements:    %zu\n", array_size);
-    printf("  Memory per array:  %.1f MB\n", mem_per_array);
-    printf("  Total memory:      %.1f MB\n", total_mem);
-    printf("  L3 Cache:          %.1f MB\n", l3_mb);
-    printf("  Arrays vs L3:      %.1fx (", total_mem / l3_mb);
-    if (total_mem > l3_mb * 4) {
-        printf("DRAM test ✓)\n");
-    } else if (total_mem > l3_mb) {
-        printf("mostly DRAM)\n");
-    } else {
-        printf("⚠ fits in L3 cache!)\n");
+    #pragma omp simd
+    for (size_t i = lo; i < hi; i++) {
+        double tmp = 0.0;
+        for (int r = 0; r < reads; r++) {
+            tmp += arrays[r % 3][i];
+        }
+        for (int w = 0; w < writes; w++) {
+            arrays[w % 3][i] = tmp * (1.0 / (w + 1));
+        }
     }
-    printf("  Iterations:        %d\n", NTIMES);
-    printf("════════════════════════════════════════════════════════════\n\n");
+    
+    return sum;
+}
 
-    // Initialize arrays in parallel (first touch policy)
-    #pragma omp parallel for simd schedule(static)
-    for (size_t i = 0; i < array_size; i++) {
-        a[i] = 1.0;
-        b[i] = 2.0;
-        c[i] = 0.0;
-    }
+// Keeps the compiler from merging or hoisting repeated passes over the same data
+#ifdef _MSC_VER
+#define COMPILER_BARRIER() _ReadWriteBarrier()
+#else
+#define COMPILER_BARRIER() __asm__ volatile("" ::: "memory")
+#endif
+
+// kernel_generic with every thread timing reps passes over its own static
+// slice; seconds for thread t are stored in times[t]
+static double kernel_per_thread(size_t n, int reads, int writes, long reps, double *times) {
+    double sum = 0.0;
+    double ticks = tsc_ticks_per_sec();
     
-    int actual_threads = 0;
-    #pragma omp parallel
+    #pragma omp parallel reduction(+:sum)
     {
-        #pragma omp single
-        actual_threads = omp_get_num_threads();
+        int tid = omp_get_thread_num();
+        size_t lo, hi;
+        thread_slice(tid, omp_get_num_threads(), n, &lo, &hi);
+        uint64_t t0 = tsc_now();
+        for (long r = 0; r < reps; r++) {
+            sum += kernel_slice(lo, hi, reads, writes);
+            COMPILER_BARRIER();
+        }
+        times[tid] = (double)(tsc_now() - t0) / ticks;
     }
-    printf("  Actual threads:    %d\n\n", actual_threads);
     
-    double times[NTIMES];
-    double dummy_sum = 0.0;
+    return sum;
+}
+
+// reps passes in one parallel region, each thread staying on its own static
+// slice, so a block that fits in a core's L1/L2 stays there between passes
+static double kernel_repeat(size_t n, int reads, int writes, long reps) {
+    double sum = 0.0;
     
-    printf("Running %d:%d benchmark...\n\n", reads, writes);
+    #pragma omp parallel reduction(+:sum)
+    {
+        size_t lo, hi;
+        thread_slice(omp_get_thread_num(), omp_get_num_threads(), n, &lo, &hi);
+        for (long r = 0; r < reps; r++) {
+            sum += kernel_slice(lo, hi, reads, writes);
+            COMPILER_BARRIER();
+        }
+    }
     
-    for (int k = 0; k < NTIMES; k++) {
+    return sum;
+}
+
+// Slice of n for thread tid proportional to weights[tid] (cache-line aligned)
+static void weighted_slice(int tid, int nt, size_t n, const double *weights,
+                           size_t *lo, size_t *hi) {
+    double total = 0.0, before = 0.0;
+    for (int t = 0; t < nt; t++) {
+        total += weights[t];
+        if (t < tid) before += weights[t];
+    }
+    *lo = (size_t)(n * (before / total)) & ~(size_t)7;
+    *hi = tid == nt - 1 ? n : (size_t)(n * ((before + weights[tid]) / total)) & ~(size_t)7;
+}
+
+// kernel_generic with per-thread slices sized by weights, so faster cores
+// get proportionally more elements and the team finishes together
+static double kernel_weighted(size_t n, int reads, int writes, const double *weights) {
+    double sum = 0.0;
+    
+    #pragma omp parallel reduction(+:sum)
+    {
+        size_t lo, hi;
+        weighted_slice(omp_get_thread_num(), omp_get_num_threads(), n, weights, &lo, &hi);
+        sum += kernel_slice(lo, hi, reads, writes);
+    }
+    
+    return sum;
+}
+
+#define MIN(x,y) ((x)<(y)?(x):(y))
+#define MAX(x,y) ((x)>(y)?(x):(y))
+
+// Thread-count steps 1, 2, 4, ... that always end exactly at max
+static int next_pow2_count(int t, int max) {
+    return (t < max && t * 2 > max) ? max : t * 2;
+}
+
+// DRAM bytes moved per element. With only 3 arrays, max unique accesses per
+// element is 3 reads + 3 writes; additional ones hit L1 cache.
+static double pattern_bytes_per_elem(int reads, int writes) {
+    return (double)(MIN(reads, 3) + MIN(writes, 3)) * sizeof(double);
+}
+
+// Byte count in KB below 1 MB, MB above
+static const char *format_bytes(char *buf, size_t len, double bytes) {
+    if (bytes < 1024.0 * 1024.0) snprintf(buf, len, "%.1f KB", bytes / 1024.0);
+    else snprintf(buf, len, "%.1f MB", bytes / (1024.0 * 1024.0));
+    return buf;
+}
+
+// Best bandwidth in MB/s over --iters iterations on the current arrays: kernel_generic,
+// or kernel_weighted when weights are given
+static double kernel_best_bw_weighted(size_t n, int reads, int writes, const double *weights) {
+    double total_bytes = pattern_bytes_per_elem(reads, writes) * n;
+    double mintime = 1e30;
+    double dummy_sum = 0.0;
+
+    // First iteration is warm-up, as in run_benchmark
+    for (int k = 0; k < opts.iters; k++) {
+        double t = get_time_sec();
+        if (weights) dummy_sum += kernel_weighted(n, reads, writes, weights);
+        else dummy_sum += kernel_generic(n, reads, writes);
+        t = get_time_sec() - t;
+        if (k > 0) mintime = MIN(mintime, t);
+    }
+    if (dummy_sum < -1e30) printf("%f", dummy_sum);
+
+    return total_bytes / mintime / 1e6;
+}
+
+static double kernel_best_bw(size_t n, int reads, int writes) {
+    return kernel_best_bw_weighted(n, reads, writes, NULL);
+}
+
+// ============================================================================
+// Alternative loop schedules: dynamic / guided (OpenMP runtime) and a
+// lock-free work-stealing scheduler over page-aligned chunks
+// ============================================================================
+
+// NUMA node of the calling thread (0 when unknown)
+static int current_node(void) {
+#if defined(__linux__)
+    const cpu_topo_t *t = topology_find(sched_getcpu());
+    return t ? t->node : 0;
+#else
+    return 0;
+#endif
+}
+
+// kernel_generic with a runtime schedule (omp_set_schedule). If finish is
+// given, finish[t] receives thread t's seconds from region start to its last
+// chunk, before the closing barrier.
+static double kernel_scheduled(size_t n, int reads, int writes, double *finish) {
+    double sum = 0.0;
+    double *arrays[3] = {a, b, c};
+    double ticks = tsc_ticks_per_sec();
+    uint64_t t0 = tsc_now();
+    
+    #pragma omp parallel
+    {
+        if (writes == 0 && reads > 0) {
+            #pragma omp for simd reduction(+:sum) schedule(runtime) nowait
+            for (size_t i = 0; i < n; i++) {
+                double tmp = 0.0;
+                for (int r = 0; r < reads; r++) {
+                    tmp += arrays[r % 3][i];
+                }
+                sum += tmp;
+            }
+        } else {
+            #pragma omp for simd schedule(runtime) nowait
+            for (size_t i = 0; i < n; i++) {
+                double tmp = 0.0;
+                for (int r = 0; r < reads; r++) {
+                    tmp += arrays[r % 3][i];
+                }
+                for (int w = 0; w < writes; w++) {
+                    arrays[w % 3][i] = tmp * (1.0 / (w + 1));
+                }
+            }
+        }
+        if (finish) finish[omp_get_thread_num()] = (double)(tsc_now() - t0) / ticks;
+    }
+    
+    return sum;
+}
+
+// Each thread owns a contiguous run of chunks. Owner and thieves both claim
+// chunks with fetch-and-add on the same counter, so no locks are needed.
+typedef struct {
+    __attribute__((aligned(64))) size_t next;   // Next chunk to claim
+    size_t end;                                 // One past the owner's last chunk
+    int node;                                   // Owner's NUMA node
+} steal_range_t;
+
+static steal_range_t steal_ranges[MAX_CPUS];
+
+static double kernel_steal(size_t n, int reads, int writes, size_t chunk, double *finish) {
+    double sum = 0.0;
+    // The arrays are PAGE_ALIGN-aligned and chunk is whole pages, so every
+    // chunk starts on a page boundary
+    size_t nchunks = (n + chunk - 1) / chunk;
+    double ticks = tsc_ticks_per_sec();
+    uint64_t t0 = tsc_now();
+    
+    #pragma omp parallel reduction(+:sum)
+    {
+        int tid = omp_get_thread_num(), nt = omp_get_num_threads();
+        steal_range_t *mine = &steal_ranges[tid];
+        mine->next = nchunks * tid / nt;
+        mine->end = nchunks * (tid + 1) / nt;
+        mine->node = current_node();
+        #pragma omp barrier
+        
+        // Pass 0: own range, then victims on our node; pass 1: remote victims
+        for (int pass = 0; pass < 2; pass++) {
+            for (int v = 0; v < nt; v++) {
+                steal_range_t *r = &steal_ranges[(tid + v) % nt];
+                int local = r->node == mine->node;
+                if (pass == 0 ? !local : local) continue;
+                for (;;) {
+                    size_t k = __atomic_fetch_add(&r->next, 1, __ATOMIC_RELAXED);
+                    if (k >= r->end) break;
+                    size_t hi = MIN((k + 1) * chunk, n);
+                    sum += kernel_slice(k * chunk, hi, reads, writes);
+                }
+            }
+        }
+        if (finish) finish[tid] = (double)(tsc_now() - t0) / ticks;
+    }
+    
+    return sum;
+}
+
+static const char *schedule_name(sched_kind_t s) {
+    switch (s) {
+    case SCHED_DYNAMIC: return "dynamic";
+    case SCHED_GUIDED:  return "guided";
+    case SCHED_STEAL:   return "steal";
+    case SCHED_STATIC:
+    default:            return "static";
+    }
+}
+
+static size_t schedule_chunk_elems(void) {
+    size_t elems = opts.chunk_bytes / sizeof(double);
+    if (opts.schedule == SCHED_STEAL) {
+        // Whole pages only
+        size_t page_elems = 4096 / sizeof(double);
+        elems = (elems + page_elems - 1) / page_elems * page_elems;
+    }
+    return elems ? elems : 1;
+}
+
+// One timed-loop kernel call under --schedule
+static double kernel_run(size_t n, int reads, int writes, double *finish) {
+    switch (opts.schedule) {
+    case SCHED_DYNAMIC:
+        omp_set_schedule(omp_sched_dynamic, (int)schedule_chunk_elems());
+        return kernel_scheduled(n, reads, writes, finish);
+    case SCHED_GUIDED:
+        omp_set_schedule(omp_sched_guided, (int)schedule_chunk_elems());
+        return kernel_scheduled(n, reads, writes, finish);
+    case SCHED_STEAL:
+        return kernel_steal(n, reads, writes, schedule_chunk_elems(), finish);
+    case SCHED_STATIC:
+    default:
+        if (!finish) return kernel_generic(n, reads, writes);
+        omp_set_schedule(omp_sched_static, 0);
+        return kernel_scheduled(n, reads, writes, finish);
+    }
+}
+
+// reps passes as one timed sample. Only the static schedule keeps each
+// thread on the same block; the others rebalance on every pass.
+static double kernel_run_reps(size_t n, int reads, int writes, long reps) {
+    if (reps == 1) return kernel_run(n, reads, writes, NULL);
+    if (opts.schedule == SCHED_STATIC) return kernel_repeat(n, reads, writes, reps);
+    double sum = 0.0;
+    for (long r = 0; r < reps; r++) sum += kernel_run(n, reads, writes, NULL);
+    return sum;
+}
+
+// ============================================================================
+// Pointer-chase latency probe
+// ============================================================================
+
+#define CHASE_STEPS (1 << 22)   // Dependent loads per measurement
+
+// One pointer per cache line, linked in random order into a single cycle, so
+// every load depends on the previous one and the prefetchers cannot help
+static void **chase_build(size_t bytes, size_t line) {
+    size_t n = MAX(bytes / line, 2);
+    char *buf = (char *)alloc_aligned(4096, n * line);
+    size_t *order = (size_t *)malloc(n * sizeof(size_t));
+    if (!buf || !order) {
+        if (buf) aligned_free(buf);
+        free(order);
+        return NULL;
+    }
+
+    // Fisher-Yates shuffle with a fixed xorshift seed: repeatable chains
+    uint64_t x = 0x9E3779B97F4A7C15ULL;
+    for (size_t i = 0; i < n; i++) order[i] = i;
+    for (size_t i = n - 1; i > 0; i--) {
+        x ^= x << 13;
+        x ^= x >> 7;
+        x ^= x << 17;
+        size_t j = (size_t)(x % (i + 1));
+        size_t tmp = order[i];
+        order[i] = order[j];
+        order[j] = tmp;
+    }
+    for (size_t i = 0; i < n; i++) {
+        *(void **)(buf + order[i] * line) = buf + order[(i + 1) % n] * line;
+    }
+    free(order);
+    return (void **)buf;
+}
+
+static void *volatile chase_sink;
+
+// Nanoseconds per dependent load
+static double chase_ns(void **chain, size_t steps) {
+    void **p = chain;
+    double t = get_time_sec();
+    for (size_t i = 0; i < steps; i += 8) {
+        p = (void **)*p; p = (void **)*p; p = (void **)*p; p = (void **)*p;
+        p = (void **)*p; p = (void **)*p; p = (void **)*p; p = (void **)*p;
+    }
+    t = get_time_sec() - t;
+    chase_sink = p;
+    return t * 1e9 / steps;
+}
+
+// ============================================================================
+// Empirical cache sizes from the knees of a latency sweep
+// ============================================================================
+
+#define PROBE_MIN_BYTES 4096
+#define PROBE_MIN_MAX (128UL << 20)  // Sweep at least this far past the start
+#define PROBE_STEPS_PER_2X 4
+#define PROBE_CHASES (1 << 19)      // Dependent loads per point and thread
+#define PROBE_REPEATS 3             // Best of this many chases per point
+#define PROBE_RISE_STEP 1.2         // Step-to-step rise that belongs to a transition
+#define PROBE_RISE_KNEE 1.5         // Overall rise that makes a transition a boundary
+#define PROBE_LEVELS 3
+#define PROBE_MAX_POINTS 128
+
+typedef struct {
+    size_t size[PROBE_LEVELS];      // Effective L1/L2/L3 for one core, 0 = no knee
+    double ns[PROBE_LEVELS];        // Load latency on the plateau below each knee
+    double mem_ns;                  // Latency at the largest size
+    size_t shared_l3;               // Aggregate L3 knee with all threads chasing, 0 = none
+    int threads;                    // Threads in the shared sweep, 1 = not run
+    int pinned;                     // Sweeps ran on pinned threads
+    size_t max_bytes;               // Largest working set swept
+} cache_probe_t;
+
+// Mean ns per load with nt threads each chasing its own chain of bytes / nt;
+// each thread keeps its best of PROBE_REPEATS so one interrupt is not a knee.
+// Barriers line the chases up so the threads really share the caches.
+// Returns -1 if no thread could allocate its chain.
+static double probe_latency(size_t bytes, int nt, size_t line) {
+    double total = 0.0;
+    int ok = 0;
+    #pragma omp parallel num_threads(nt) reduction(+:total, ok)
+    {
+        size_t share = MAX(bytes / omp_get_num_threads(), 2 * line);
+        void **chain = chase_build(share, line);
+        double best = 1e30;
+        #pragma omp barrier
+        if (chain) chase_ns(chain, MIN(share / line, PROBE_CHASES));
+        for (int r = 0; r < PROBE_REPEATS; r++) {
+            #pragma omp barrier
+            if (chain) best = MIN(best, chase_ns(chain, PROBE_CHASES));
+        }
+        if (chain) {
+            total += best;
+            ok++;
+            aligned_free(chain);
+        }
+    }
+    return ok ? total / ok : -1.0;
+}
+
+// Rises by PROBE_RISE_STEP within the next two points
+static int probe_rising(const double *lat, int n, int j) {
+    return (j + 1 < n && lat[j + 1] >= lat[j] * PROBE_RISE_STEP) ||
+           (j + 2 < n && lat[j + 2] >= lat[j] * PROBE_RISE_STEP);
+}
+
+// Capacities from a latency curve, after a 3-point median removes lone spikes.
+// Points rising by PROBE_RISE_STEP (looking two ahead, so one flat step does not
+// split a gradual rise) form one transition; a transition that rises
+// PROBE_RISE_KNEE overall, and is still that high one step later, is a cache
+// boundary. It is placed where the curve crosses the geometric mean of the
+// latencies either side (interpolated in log size).
+static int probe_knees(const size_t *sizes, const double *raw, int n,
+                       size_t *cap, double *below, int max) {
+    double lat[PROBE_MAX_POINTS];
+    for (int i = 0; i < n; i++) {
+        if (i == 0 || i == n - 1) {
+            lat[i] = raw[i];
+        } else {
+            double lo = MIN(raw[i - 1], raw[i + 1]), hi = MAX(raw[i - 1], raw[i + 1]);
+            lat[i] = raw[i] < lo ? lo : raw[i] > hi ? hi : raw[i];
+        }
+    }
+
+    int found = 0;
+    for (int i = 0; i + 1 < n && found < max;) {
+        if (!probe_rising(lat, n, i)) {
+            i++;
+            continue;
+        }
+        int j = i + 1;
+        while (probe_rising(lat, n, j)) j++;
+        if (j + 1 < n && MIN(lat[j], lat[j + 1]) >= lat[i] * PROBE_RISE_KNEE) {
+            double mid = sqrt(lat[i] * lat[j]);
+            int k = i;
+            while (lat[k + 1] < mid) k++;
+            double f = log(mid / lat[k]) / log(lat[k + 1] / lat[k]);
+            cap[found] = (size_t)((double)sizes[k] * pow((double)sizes[k + 1] / sizes[k], f));
+            below[found] = lat[i];
+            found++;
+        }
+        i = j;
+    }
+    return found;
+}
+
+// Latency sweep with nt threads; stops early once PROBE_LEVELS boundaries are
+// behind a flat step. Returns the number of knees found.
+static int probe_sweep(size_t max_bytes, int nt, size_t line, size_t *cap, double *below,
+                       double *last_ns) {
+    size_t sizes[PROBE_MAX_POINTS];
+    double lat[PROBE_MAX_POINTS];
+    int n = 0, found = 0;
+    for (int i = 0; n < PROBE_MAX_POINTS; i++) {
+        size_t w = (size_t)(PROBE_MIN_BYTES * nt * pow(2.0, (double)i / PROBE_STEPS_PER_2X)) & ~(size_t)63;
+        if (w > max_bytes) break;
+        sizes[n] = w;
+        lat[n] = probe_latency(w, nt, line);
+        if (lat[n] < 0.0) break;
+        n++;
+        found = probe_knees(sizes, lat, n, cap, below, PROBE_LEVELS);
+        if (found == PROBE_LEVELS && lat[n - 1] < lat[n - 2] * PROBE_RISE_STEP) break;
+    }
+    *last_ns = n ? lat[n - 1] : 0.0;
+    return found;
+}
+
+#if defined(__linux__)
+// Pin a team of n for the probe: --bind=none falls back to one per core, as the
+// pthread backend does, since per-core knees need threads that stay put.
+// Returns 1 if the team was pinned.
+static int probe_pin(int n) {
+    int plan[MAX_CPUS];
+    if (binding_plan(opts.bind == BIND_NONE ? BIND_CORE : opts.bind, opts.bind_list, n, plan) <= 0) {
+        return 0;
+    }
+    pin_team(plan, n);
+    return 1;
+}
+#endif
+
+// Per-core sweep on one thread, then (for num_threads > 1) all threads at once
+// for the shared L3
+static void probe_cache(const cache_info_t *cache, int num_threads, cache_probe_t *probe) {
+    size_t cap[PROBE_LEVELS];
+    double below[PROBE_LEVELS], shared_ns;
+    size_t line = cache->line_size ? cache->line_size : 64;
+
+    memset(probe, 0, sizeof(*probe));
+    probe->max_bytes = MAX(cache_l3_total(cache) * 4, PROBE_MIN_MAX);
+    printf("Measuring cache sizes (pointer chase up to %zu MB)...\n\n", probe->max_bytes >> 20);
+    fflush(stdout);
+
+#if defined(__linux__)
+    cpu_set_t saved_mask;
+    sched_getaffinity(0, sizeof(saved_mask), &saved_mask);
+    probe->pinned = probe_pin(1);
+#endif
+    int found = probe_sweep(probe->max_bytes, 1, line, cap, below, &probe->mem_ns);
+    for (int k = 0; k < found; k++) {
+        probe->size[k] = cap[k];
+        probe->ns[k] = below[k];
+    }
+
+    probe->threads = 1;
+    if (num_threads > 1) {
+        probe->threads = num_threads;
+#if defined(__linux__)
+        probe->pinned &= probe_pin(num_threads);
+#endif
+        // Private levels show up at num_threads times their size, and when that
+        // reaches the L3 the L2 and L3 knees merge. The shared L3 knee is the one
+        // whose plateau below is slower than one core's L2, i.e. already in L3.
+        double l2_ns = probe->ns[1] > 0.0 ? probe->ns[1] : probe->ns[0];
+        int shared = probe_sweep(probe->max_bytes, num_threads, line, cap, below, &shared_ns);
+        for (int k = 0; l2_ns > 0.0 && k < shared; k++) {
+            if (below[k] >= l2_ns * PROBE_RISE_KNEE) {
+                probe->shared_l3 = cap[k];
+                break;
+            }
+        }
+    }
+
+#if defined(__linux__)
+    // Undo the fallback pinning so later runs under --bind=none stay unpinned
+    if (opts.bind == BIND_NONE) {
+        #pragma omp parallel num_threads(num_threads)
+        sched_setaffinity(0, sizeof(saved_mask), &saved_mask);
+    }
+#endif
+}
+
+static void print_probe_row(const char *level, double detected, size_t measured, double ns) {
+    char det[32], meas[32];
+    format_bytes(det, sizeof(det), detected);
+    if (measured) format_bytes(meas, sizeof(meas), (double)measured);
+    else snprintf(meas, sizeof(meas), "-");
+    printf("  %-16s %10s  %10s", level, det, meas);
+    if (ns > 0.0) printf("  %7.1f ns", ns);
+    printf("\n");
+}
+
+static void print_cache_probe(const cache_info_t *cache, const cache_probe_t *probe) {
+    char label[32];
+    printf("════════════════════════════════════════════════════════════\n");
+    printf("  Cache Sizes: Detected vs Measured (latency knees)\n");
+    printf("════════════════════════════════════════════════════════════\n");
+    printf("  %-16s %10s  %10s  %10s\n", "Level", "Detected", "Measured", "Latency");
+    print_probe_row("L1 Data", (double)cache->l1d_size, probe->size[0], probe->ns[0]);
+    print_probe_row("L2", (double)cache->l2_size, probe->size[1], probe->ns[1]);
+    print_probe_row("L3 (one core)", (double)cache->l3_size, probe->size[2], probe->ns[2]);
+    if (probe->threads > 1) {
+        snprintf(label, sizeof(label), "L3 (%d threads)", probe->threads);
+        print_probe_row(label, (double)cache_l3_total(cache), probe->shared_l3, 0.0);
+    }
+    printf("  %-16s %10s  %10s  %7.1f ns\n", "Memory", "", "", probe->mem_ns);
+    printf("  - = no knee below %zu MB (or merged with the L2 knee)\n", probe->max_bytes >> 20);
+    if (!probe->pinned) printf("  ⚠ Threads were not pinned: per-core values may mix cores\n");
+    printf("════════════════════════════════════════════════════════════\n\n");
+}
+
+// --auto-size=empirical: measured sizes replace the detected ones they cover
+static void apply_cache_probe(cache_info_t *cache, const cache_probe_t *probe) {
+    if (probe->size[0]) cache->l1d_size = probe->size[0];
+    if (probe->size[1]) cache->l2_size = probe->size[1];
+    if (probe->size[2]) {
+        cache->l3_size = probe->size[2];
+    } else {
+        printf("  No L3 knee measured; auto-sizing keeps the detected L3\n\n");
+    }
+}
+
+// ============================================================================
+// Persistent pinned pthread team (alternative to OpenMP, Linux only)
+// ============================================================================
+
+#if defined(__linux__)
+#define POOL_START_DELAY 50e-6  // Seconds between release and the common start
+
+// Sense-reversing spin barrier: the last thread to arrive resets the count
+// and flips the shared sense; everyone else spins until it matches theirs.
+typedef struct {
+    __attribute__((aligned(64))) int count;
+    __attribute__((aligned(64))) int sense;
+    int n;
+} spin_barrier_t;
+
+static void spin_barrier_init(spin_barrier_t *b, int n) {
+    b->count = n;
+    b->sense = 0;
+    b->n = n;
+}
+
+static void spin_barrier_wait(spin_barrier_t *b, int *local_sense) {
+    unsigned spins = 0;
+    *local_sense = !*local_sense;
+    if (__atomic_sub_fetch(&b->count, 1, __ATOMIC_ACQ_REL) == 0) {
+        __atomic_store_n(&b->count, b->n, __ATOMIC_RELAXED);
+        __atomic_store_n(&b->sense, *local_sense, __ATOMIC_RELEASE);
+    } else {
+        while (__atomic_load_n(&b->sense, __ATOMIC_ACQUIRE) != *local_sense) spin_relax(&spins);
+    }
+}
+
+typedef enum {
+    POOL_INIT = 0,      // First-touch the thread's slice of a, b, c
+    POOL_KERNEL,        // One kernel pass over the slice
+    POOL_STOP,
+} pool_cmd_t;
+
+// Per-thread results, one cache line each
+typedef struct {
+    __attribute__((aligned(64))) double sum;
+    uint64_t start;     // TSC when this thread began its slice
+    uint64_t end;       // TSC when this thread finished its slice
+    int cpu;            // sched_getcpu() at the end of the last command
+} pool_slot_t;
+
+typedef struct {
+    int num_threads;
+    int main_sense;
+    pthread_t threads[MAX_CPUS];
+    int cpus[MAX_CPUS];
+    pool_slot_t slots[MAX_CPUS];
+    spin_barrier_t barrier;
+    cpu_set_t saved_mask;   // Main thread's affinity before pool_start
+    // Current command, published before the start barrier
+    pool_cmd_t cmd;
+    size_t n;
+    int reads, writes;
+    long reps;              // Passes over the slice per POOL_KERNEL
+    uint64_t deadline;      // TSC at which every thread starts the kernel
+} worker_pool_t;
+
+static worker_pool_t pool;
+
+static void pool_execute(int tid) {
+    size_t lo, hi;
+    pool_slot_t *slot = &pool.slots[tid];
+    thread_slice(tid, pool.num_threads, pool.n, &lo, &hi);
+
+    if (pool.cmd == POOL_INIT) {
+        for (size_t i = lo; i < hi; i++) {
+            a[i] = 1.0;
+            b[i] = 2.0;
+            c[i] = 0.0;
+        }
+    } else {
+        while (tsc_now() < pool.deadline) { }
+        slot->start = tsc_now();
+        for (long r = 0; r < pool.reps; r++) {
+            slot->sum += kernel_slice(lo, hi, pool.reads, pool.writes);
+            COMPILER_BARRIER();
+        }
+        slot->end = tsc_now();
+    }
+    slot->cpu = sched_getcpu();
+}
+
+static void *pool_worker(void *arg) {
+    int tid = (int)(intptr_t)arg;
+    int sense = 0;
+    if (pool.cpus[tid] >= 0) pin_to_cpu(pool.cpus[tid]);
+
+    for (;;) {
+        spin_barrier_wait(&pool.barrier, &sense);
+        if (pool.cmd == POOL_STOP) break;
+        pool_execute(tid);
+        spin_barrier_wait(&pool.barrier, &sense);
+    }
+    return NULL;
+}
+
+// Start num_threads - 1 workers; the calling thread is worker 0.
+// The team is always pinned: --bind=none falls back to one per core.
+static int pool_start(int num_threads) {
+    int ret = binding_plan(opts.bind == BIND_NONE ? BIND_CORE : opts.bind,
+                           opts.bind_list, num_threads, pool.cpus);
+    if (ret < 0) return -1;
+    if (ret == 0) {
+        for (int t = 0; t < num_threads; t++) pool.cpus[t] = -1;
+    }
+
+    pool.num_threads = num_threads;
+    pool.main_sense = 0;
+    pool.reps = 1;
+    memset(pool.slots, 0, sizeof(pool.slots));
+    spin_barrier_init(&pool.barrier, num_threads);
+    tsc_ticks_per_sec();
+
+    sched_getaffinity(0, sizeof(pool.saved_mask), &pool.saved_mask);
+    if (pool.cpus[0] >= 0) pin_to_cpu(pool.cpus[0]);
+    for (int t = 1; t < num_threads; t++) {
+        if (pthread_create(&pool.threads[t], NULL, pool_worker, (void *)(intptr_t)t) != 0) {
+            fprintf(stderr, "Error: pthread_create: %s\n", strerror(errno));
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// Run one command on the whole team. For POOL_KERNEL, returns the seconds
+// from the common start deadline until the last thread finished its slice.
+static double pool_run(pool_cmd_t cmd, size_t n, int reads, int writes) {
+    pool.cmd = cmd;
+    pool.n = n;
+    pool.reads = reads;
+    pool.writes = writes;
+    pool.deadline = tsc_now() + (uint64_t)(tsc_ticks_per_sec() * POOL_START_DELAY);
+
+    spin_barrier_wait(&pool.barrier, &pool.main_sense);
+    pool_execute(0);
+    spin_barrier_wait(&pool.barrier, &pool.main_sense);
+
+    if (cmd != POOL_KERNEL) return 0.0;
+    uint64_t last = pool.deadline;
+    for (int t = 0; t < pool.num_threads; t++) last = MAX(last, pool.slots[t].end);
+    return (double)(last - pool.deadline) / tsc_ticks_per_sec();
+}
+
+// Same contract as sample_thread_cpus, for the pthread team
+static void pool_sample_cpus(int *cpus, int *moved) {
+    for (int t = 0; t < pool.num_threads; t++) {
+        if (moved && cpus[t] >= 0 && cpus[t] != pool.slots[t].cpu) moved[t]++;
+        cpus[t] = pool.slots[t].cpu;
+    }
+}
+
+static double pool_sum(void) {
+    double sum = 0.0;
+    for (int t = 0; t < pool.num_threads; t++) sum += pool.slots[t].sum;
+    return sum;
+}
+
+static void pool_stop(void) {
+    pool.cmd = POOL_STOP;
+    spin_barrier_wait(&pool.barrier, &pool.main_sense);
+    for (int t = 1; t < pool.num_threads; t++) pthread_join(pool.threads[t], NULL);
+    sched_setaffinity(0, sizeof(pool.saved_mask), &pool.saved_mask);
+}
+#endif
+
+// ============================================================================
+// Sample statistics
+// ============================================================================
+
+static int cmp_double(const void *x, const void *y) {
+    double p = *(const double *)x, q = *(const double *)y;
+    return (p > q) - (p < q);
+}
+
+typedef struct {
+    int n;
+    double min, max, mean;
+    double stddev;          // Sample standard deviation
+    double cv;              // stddev / mean
+    double p5, p25, median, p75, p95;
+} stats_t;
+
+// Linear interpolation between closest ranks of a sorted sample
+static double percentile_sorted(const double *sorted, int n, double p) {
+    if (n == 1) return sorted[0];
+    double pos = p / 100.0 * (n - 1);
+    int i = (int)pos;
+    if (i >= n - 1) return sorted[n - 1];
+    return sorted[i] + (pos - i) * (sorted[i + 1] - sorted[i]);
+}
+
+static stats_t compute_stats(const double *v, int n) {
+    stats_t s = {0};
+    s.n = n;
+    if (n == 0) return s;
+    s.min = s.max = v[0];
+    for (int i = 0; i < n; i++) {
+        s.min = MIN(s.min, v[i]);
+        s.max = MAX(s.max, v[i]);
+        s.mean += v[i] / n;
+    }
+    double ss = 0.0;
+    for (int i = 0; i < n; i++) ss += (v[i] - s.mean) * (v[i] - s.mean);
+    s.stddev = n > 1 ? sqrt(ss / (n - 1)) : 0.0;
+    s.cv = s.mean > 0.0 ? s.stddev / s.mean : 0.0;
+
+    double *sorted = (double *)malloc(n * sizeof(double));
+    if (sorted) {
+        memcpy(sorted, v, n * sizeof(double));
+        qsort(sorted, n, sizeof(double), cmp_double);
+        s.p5 = percentile_sorted(sorted, n, 5);
+        s.p25 = percentile_sorted(sorted, n, 25);
+        s.median = percentile_sorted(sorted, n, 50);
+        s.p75 = percentile_sorted(sorted, n, 75);
+        s.p95 = percentile_sorted(sorted, n, 95);
+        free(sorted);
+    }
+    return s;
+}
+
+#define BOOTSTRAP_RESAMPLES 2000
+
+// Percentile bootstrap 95% CI of the median (fixed seed: repeatable output)
+static void bootstrap_median_ci(const double *v, int n, double *lo, double *hi) {
+    double *medians = (double *)malloc(BOOTSTRAP_RESAMPLES * sizeof(double));
+    double *sample = (double *)malloc(n * sizeof(double));
+    *lo = *hi = 0.0;
+    if (!medians || !sample || n == 0) {
+        free(medians);
+        free(sample);
+        return;
+    }
+    uint64_t x = 0x2545F4914F6CDD1DULL;
+    for (int r = 0; r < BOOTSTRAP_RESAMPLES; r++) {
+        for (int i = 0; i < n; i++) {
+            x ^= x << 13;
+            x ^= x >> 7;
+            x ^= x << 17;
+            sample[i] = v[x % n];
+        }
+        qsort(sample, n, sizeof(double), cmp_double);
+        medians[r] = percentile_sorted(sample, n, 50);
+    }
+    qsort(medians, BOOTSTRAP_RESAMPLES, sizeof(double), cmp_double);
+    *lo = percentile_sorted(medians, BOOTSTRAP_RESAMPLES, 2.5);
+    *hi = percentile_sorted(medians, BOOTSTRAP_RESAMPLES, 97.5);
+    free(medians);
+    free(sample);
+}
+
+#define HIST_BINS 10
+#define HIST_WIDTH 40
+
+// ASCII histogram over [min, max]; two clusters here are the bimodal case
+// that a single best or mean hides
+static void print_histogram(const double *v, int n, const char *unit) {
+    stats_t s = compute_stats(v, n);
+    int count[HIST_BINS] = {0}, peak = 0;
+    double width = (s.max - s.min) / HIST_BINS;
+    for (int i = 0; i < n; i++) {
+        int bin = width > 0.0 ? (int)((v[i] - s.min) / width) : 0;
+        if (bin >= HIST_BINS) bin = HIST_BINS - 1;
+        count[bin]++;
+        peak = MAX(peak, count[bin]);
+    }
+    for (int b = 0; b < HIST_BINS; b++) {
+        printf("  %10.1f - %10.1f %s |", s.min + b * width, s.min + (b + 1) * width, unit);
+        int bar = peak ? (count[b] * HIST_WIDTH + peak - 1) / peak : 0;
+        for (int i = 0; i < bar; i++) printf("#");
+        printf(" %d\n", count[b]);
+        if (width == 0.0) break;
+    }
+}
+
+#define ADAPTIVE_MIN_SAMPLES 10     // Timed iterations before --adaptive may stop
+
+// Half-width of the distribution-free 95% CI of the median, from the order
+// statistics at n/2 -+ 0.98*sqrt(n), relative to the median
+static double median_ci_rel(const double *v, int n) {
+    if (n < 2) return 1.0;
+    double *sorted = (double *)malloc(n * sizeof(double));
+    if (!sorted) return 1.0;
+    memcpy(sorted, v, n * sizeof(double));
+    qsort(sorted, n, sizeof(double), cmp_double);
+    int lo = (int)floor(n / 2.0 - 0.98 * sqrt(n));
+    int hi = (int)ceil(1 + n / 2.0 + 0.98 * sqrt(n));
+    lo = lo < 1 ? 1 : lo;
+    hi = hi > n ? n : hi;
+    double median = n % 2 ? sorted[n / 2] : 0.5 * (sorted[n / 2 - 1] + sorted[n / 2]);
+    double rel = median > 0.0 ? (sorted[hi - 1] - sorted[lo - 1]) / 2.0 / median : 1.0;
+    free(sorted);
+    return rel;
+}
+
+// Whether to time iteration k; times[1..k) are done, times[0] is warm-up.
+// Fixed: --iters iterations. Adaptive: until the median's CI is tight enough
+// or the time budget is spent.
+static int keep_iterating(const double *times, int k, double started) {
+    if (opts.adaptive_ci <= 0.0) return k < opts.iters;
+    if (k < ADAPTIVE_MIN_SAMPLES + 1) return 1;
+    if (get_time_sec() - started >= opts.budget) return 0;
+    return median_ci_rel(times + 1, k - 1) > opts.adaptive_ci;
+}
+
+// ============================================================================
+// Fork/join and barrier overhead
+// ============================================================================
+
+#define FJ_REPS 1000        // Operations per trial
+#define FJ_TRIALS 5         // Best trial is reported
+#define FJ_MARGIN 20        // Warn when an iteration is under this many fork/joins
+
+typedef enum {
+    FJ_PARALLEL = 0,        // Empty omp parallel region
+    FJ_BARRIER,             // omp barrier inside one region
+    FJ_FOR,                 // Empty omp for (one iteration per thread) + implicit barrier
+    FJ_SPIN,                // Sense-reversing spin barrier (Linux)
+    FJ_KINDS
+} fj_kind_t;
+
+static double fj_trial(fj_kind_t kind, int reps) {
+    volatile int sink = 0;
+    double t = 0.0;
+    
+    if (kind == FJ_PARALLEL) {
+        t = get_time_sec();
+        for (int r = 0; r < reps; r++) {
+            #pragma omp parallel
+            {
+                if (omp_get_thread_num() == 0) sink++;
+            }
+        }
+        return (get_time_sec() - t) / reps;
+    }
+    
+#if defined(__linux__)
+    spin_barrier_t spin;
+#endif
+    #pragma omp parallel
+    {
+        int nt = omp_get_num_threads();
+#if defined(__linux__)
+        int sense = 0;
+        #pragma omp single
+        spin_barrier_init(&spin, nt);
+#endif
+        #pragma omp master
+        t = get_time_sec();
+        for (int r = 0; r < reps; r++) {
+            if (kind == FJ_BARRIER) {
+                #pragma omp barrier
+            } else if (kind == FJ_FOR) {
+                #pragma omp for schedule(static)
+                for (int i = 0; i < nt; i++) sink = i;
+            }
+#if defined(__linux__)
+            else {
+                spin_barrier_wait(&spin, &sense);
+            }
+#endif
+        }
+        #pragma omp master
+        t = get_time_sec() - t;
+    }
+    return t / reps;
+}
+
+// Seconds per operation with the current omp_set_num_threads() team
+static double fork_join_cost(fj_kind_t kind, int reps) {
+#if !defined(__linux__)
+    if (kind == FJ_SPIN) return 0.0;
+#endif
+    fj_trial(kind, reps / 10 + 1);          // Warm up the team
+    double best = fj_trial(kind, reps);
+    for (int k = 1; k < FJ_TRIALS; k++) best = MIN(best, fj_trial(kind, reps));
+    return best;
+}
+
+// ============================================================================
+// System noise sampling around timed iterations (--noise, Linux only)
+// ============================================================================
+
+#if defined(__linux__)
+typedef struct {
+    uint64_t irqs;          // Interrupts on the bound CPUs, timer and IPIs excluded
+    uint64_t ctxt;          // schedule() calls on the bound CPUs, or system-wide switches
+    uint64_t migrations;    // se.nr_migrations summed over our threads
+    uint64_t switches;      // nr_switches summed over our threads
+    uint64_t invol;         // Involuntary context switches (getrusage)
+    uint64_t majflt;        // Major page faults (getrusage)
+    uint64_t minflt;        // Minor page faults (getrusage)
+} noise_sample_t;
+
+// Lines of /proc/interrupts that are not noise: LOC is the periodic tick, present
+// in every iteration; RES, CAL and TLB are the IPIs the OpenMP runtime itself
+// causes when it wakes its team and the kernel maps its pages
+static int noise_irq_expected(const char *line) {
+    static const char *const names[] = { "LOC:", "RES:", "CAL:", "TLB:" };
+    while (*line == ' ') line++;
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+        if (strncmp(line, names[i], strlen(names[i])) == 0) return 1;
+    }
+    return 0;
+}
+
+// Interrupt counts from /proc/interrupts for CPUs in cpus[0..n) (all CPUs if
+// none are known)
+static uint64_t noise_irqs(const int *cpus, int n) {
+    FILE *f = fopen("/proc/interrupts", "r");
+    if (!f) return 0;
+
+    char *line = NULL;
+    size_t cap = 0;
+    int col_cpu[MAX_CPUS], ncols = 0;
+    unsigned char want[MAX_CPUS] = {0};
+    int any = 0;
+    for (int i = 0; i < n; i++) {
+        if (cpus[i] >= 0 && cpus[i] < MAX_CPUS) want[cpus[i]] = any = 1;
+    }
+
+    // Header: "CPU0 CPU1 ..." gives the CPU of each column
+    if (getline(&line, &cap, f) > 0) {
+        for (char *p = line; (p = strstr(p, "CPU")) && ncols < MAX_CPUS; p += 3) {
+            col_cpu[ncols++] = atoi(p + 3);
+        }
+    }
+    uint64_t total = 0;
+    while (getline(&line, &cap, f) > 0) {
+        char *p = strchr(line, ':');
+        if (!p || noise_irq_expected(line)) continue;
+        p++;
+        for (int c = 0; c < ncols; c++) {
+            char *end;
+            unsigned long long v = strtoull(p, &end, 10);
+            if (end == p) break;
+            p = end;
+            if (!any || (col_cpu[c] < MAX_CPUS && want[col_cpu[c]])) total += v;
+        }
+    }
+    free(line);
+    fclose(f);
+    return total;
+}
+
+static int noise_ctxt_percpu = -1;   // /proc/schedstat readable, -1 = not yet tried
+
+// schedule() calls on cpus[0..n) from /proc/schedstat (third field of each
+// cpuN line), or the system-wide ctxt of /proc/stat when schedstats are off
+static uint64_t noise_ctxt(const int *cpus, int n) {
+    if (noise_ctxt_percpu != 0) {
+        FILE *f = fopen("/proc/schedstat", "r");
+        noise_ctxt_percpu = f != NULL;
+        if (f) {
+            char line[512];
+            uint64_t total = 0;
+            while (fgets(line, sizeof(line), f)) {
+                int cpu;
+                unsigned long long yld, legacy, count;
+                if (sscanf(line, "cpu%d %llu %llu %llu", &cpu, &yld, &legacy, &count) != 4) continue;
+                for (int i = 0; i < n; i++) {
+                    if (cpus[i] == cpu) {
+                        total += count;
+                        break;
+                    }
+                }
+            }
+            fclose(f);
+            return total;
+        }
+    }
+
+    FILE *f = fopen("/proc/stat", "r");
+    if (!f) return 0;
+    char line[256];
+    unsigned long long v = 0;
+    while (fgets(line, sizeof(line), f)) {
+        if (sscanf(line, "ctxt %llu", &v) == 1) break;
+    }
+    fclose(f);
+    return v;
+}
+
+// Sum migrations and switches over every thread of this process
+static void noise_tasks(uint64_t *migrations, uint64_t *switches) {
+    *migrations = *switches = 0;
+    DIR *dir = opendir("/proc/self/task");
+    if (!dir) return;
+    struct dirent *e;
+    while ((e = readdir(dir)) != NULL) {
+        if (e->d_name[0] == '.') continue;
+        char path[300], line[256], key[64];
+        snprintf(path, sizeof(path), "/proc/self/task/%s/sched", e->d_name);
+        FILE *f = fopen(path, "r");
+        if (!f) continue;
+        while (fgets(line, sizeof(line), f)) {
+            unsigned long long v;
+            if (sscanf(line, "%63s : %llu", key, &v) != 2) continue;
+            if (strcmp(key, "se.nr_migrations") == 0) *migrations += v;
+            else if (strcmp(key, "nr_switches") == 0) *switches += v;
+        }
+        fclose(f);
+    }
+    closedir(dir);
+}
+
+static void noise_snapshot(noise_sample_t *s, const int *cpus, int n) {
+    struct rusage ru;
+    s->irqs = noise_irqs(cpus, n);
+    s->ctxt = noise_ctxt(cpus, n);
+    noise_tasks(&s->migrations, &s->switches);
+    getrusage(RUSAGE_SELF, &ru);
+    s->invol = (uint64_t)ru.ru_nivcsw;
+    s->majflt = (uint64_t)ru.ru_majflt;
+    s->minflt = (uint64_t)ru.ru_minflt;
+}
+
+// Union of the affinity masks of this process's threads: the CPUs the
+// benchmark is bound to (every allowed CPU under --bind=none)
+static int noise_bound_cpus(int *cpus) {
+    cpu_set_t all;
+    CPU_ZERO(&all);
+    DIR *dir = opendir("/proc/self/task");
+    if (dir) {
+        struct dirent *e;
+        while ((e = readdir(dir)) != NULL) {
+            cpu_set_t set;
+            if (e->d_name[0] == '.') continue;
+            if (sched_getaffinity((pid_t)atoi(e->d_name), sizeof(set), &set) == 0) {
+                CPU_OR(&all, &all, &set);
+            }
+        }
+        closedir(dir);
+    }
+    int n = 0;
+    for (int c = 0; c < MAX_CPUS; c++) {
+        if (CPU_ISSET(c, &all)) cpus[n++] = c;
+    }
+    return n;
+}
+
+// after -= before, field by field
+static void noise_delta(noise_sample_t *after, const noise_sample_t *before) {
+    after->irqs -= before->irqs;
+    after->ctxt -= before->ctxt;
+    after->migrations -= before->migrations;
+    after->switches -= before->switches;
+    after->invol -= before->invol;
+    after->majflt -= before->majflt;
+    after->minflt -= before->minflt;
+}
+
+// Events that take a CPU away from the kernel loop. Minor faults and
+// voluntary switches (OpenMP threads parking) are expected and not counted.
+static int noise_is_event(const noise_sample_t *d) {
+    return d->irqs || d->migrations || d->invol || d->majflt;
+}
+
+// Per-iteration deltas, then clean vs noisy iterations (warm-up excluded)
+static void print_noise_report(const noise_sample_t *noise, const double *times,
+                               int ntimes, double total_bytes) {
+    printf("System noise per iteration on the bound CPUs (IRQs exclude timer, RES, CAL, TLB):\n");
+    printf("────────────────────────────────────────────────────────────\n");
+    printf("Iter      MB/s    IRQs  %10s  Migr  Switch  Invol  MajFlt\n",
+           noise_ctxt_percpu > 0 ? "Sched" : "Ctxt(sys)");
+    printf("────────────────────────────────────────────────────────────\n");
+    int count[2] = {0};
+    double best[2] = {0}, sum[2] = {0};
+    for (int k = 1; k < ntimes; k++) {
+        const noise_sample_t *d = &noise[k];
+        double bw = total_bytes / times[k] / 1e6;
+        int noisy = noise_is_event(d);
+        printf("%4d  %8.1f  %6llu  %10llu  %4llu  %6llu  %5llu  %6llu%s\n", k, bw,
+               (unsigned long long)d->irqs, (unsigned long long)d->ctxt,
+               (unsigned long long)d->migrations, (unsigned long long)d->switches,
+               (unsigned long long)d->invol, (unsigned long long)d->majflt,
+               noisy ? "  *" : "");
+        count[noisy]++;
+        best[noisy] = MAX(best[noisy], bw);
+        sum[noisy] += bw;
+    }
+    printf("────────────────────────────────────────────────────────────\n");
+    static const char *const label[2] = { "Clean", "Noisy (*)" };
+    for (int i = 0; i < 2; i++) {
+        printf("  %-10s %3d iterations", label[i], count[i]);
+        if (count[i]) printf("   best %.1f MB/s, avg %.1f MB/s", best[i], sum[i] / count[i]);
+        printf("\n");
+    }
+    printf("\n");
+}
+#endif
+
+// ============================================================================
+// Main benchmark
+// ============================================================================
+
+// Per-thread bandwidth from times[k * nt + t] (iteration k, thread t),
+// skipping the warm-up iteration like the main table
+static void print_thread_report(const double *times, int ntimes, int nt, size_t n,
+                                int reads, int writes, long reps, const int *cpus) {
+    double bw[MAX_CPUS];
+    double sum = 0.0, sum_sq = 0.0;
+    int slowest = 0, fastest = 0;
+
+    printf("Per-thread bandwidth:\n");
+    printf("────────────────────────────────────────────────────────────\n");
+    printf("Thread   CPU  Node      Slice   Best GB/s    Avg GB/s\n");
+    printf("────────────────────────────────────────────────────────────\n");
+    for (int t = 0; t < nt; t++) {
+        size_t lo, hi;
+        thread_slice(t, nt, n, &lo, &hi);
+        double bytes = pattern_bytes_per_elem(reads, writes) * (hi - lo) * reps;
+        double best = 1e30, avg = 0.0;
+        for (int k = 1; k < ntimes; k++) {
+            best = MIN(best, times[k * nt + t]);
+            avg += times[k * nt + t];
+        }
+        avg /= (ntimes - 1);
+        bw[t] = bytes / avg / 1e9;
+        sum += bw[t];
+        sum_sq += bw[t] * bw[t];
+        if (bw[t] < bw[slowest]) slowest = t;
+        if (bw[t] > bw[fastest]) fastest = t;
+
+        int cpu = -1, node = -1;
+#if defined(__linux__)
+        const cpu_topo_t *ct = cpus ? topology_find(cpus[t]) : NULL;
+        if (ct) {
+            cpu = ct->cpu;
+            node = ct->node;
+        }
+#else
+        (void)cpus;
+#endif
+        char slice[32];
+        printf("%6d  %4d  %4d  %9s  %10.2f  %10.2f\n", t, cpu, node,
+               format_bytes(slice, sizeof(slice), (double)(hi - lo) * sizeof(double)),
+               bytes / best / 1e9, bw[t]);
+    }
+    printf("────────────────────────────────────────────────────────────\n");
+
+    // Jain's index: 1.0 when every thread gets the same bandwidth, 1/n when one gets all
+    double jain = sum * sum / (nt * sum_sq);
+    printf("  Spread (avg GB/s):  %.2f - %.2f (slowest %.1f%% below fastest)\n",
+           bw[slowest], bw[fastest], 100.0 * (1.0 - bw[slowest] / bw[fastest]));
+    printf("  Jain's fairness:    %.4f\n", jain);
+#if defined(__linux__)
+    const cpu_topo_t *ct = cpus ? topology_find(cpus[slowest]) : NULL;
+    if (ct) {
+        printf("  Slowest thread:     %d on CPU %d, node %d (%.2f GB/s)\n",
+               slowest, ct->cpu, ct->node, bw[slowest]);
+    } else
+#endif
+    printf("  Slowest thread:     %d (%.2f GB/s)\n", slowest, bw[slowest]);
+    printf("\n");
+}
+
+#define SAMPLE_MIN_SEC 1e-3     // Shortest timed sample; shorter passes are repeated
+#define MAX_REPS (1L << 30)
+
+// Passes per timed sample: doubled from 1 until a sample lasts SAMPLE_MIN_SEC.
+// Cache-resident working sets finish a pass in microseconds, far too short to
+// time on their own; DRAM-sized arrays stay at 1.
+static long calibrate_reps(size_t n, int reads, int writes, double *sink) {
+    for (long reps = 1;; reps *= 2) {
+        double t;
+#if defined(__linux__)
+        if (opts.backend == BACKEND_PTHREAD) {
+            pool.reps = reps;
+            t = pool_run(POOL_KERNEL, n, reads, writes);
+        } else
+#endif
+        {
+            t = get_time_sec();
+            *sink += kernel_run_reps(n, reads, writes, reps);
+            t = get_time_sec() - t;
+        }
+        if (t >= SAMPLE_MIN_SEC || reps >= MAX_REPS) return reps;
+    }
+}
+
+int run_benchmark(int num_threads, size_t array_size, cache_info_t *cache, int reads, int writes) {
+    omp_set_num_threads(num_threads);
+#if defined(__linux__)
+    // Pin before first touch so pages land next to the threads that use them
+    if (opts.backend == BACKEND_PTHREAD) {
+        if (pool_start(num_threads) != 0) exit(1);
+    } else if (apply_binding(num_threads) != 0) {
+        exit(1);
+    }
+#endif
+    
+    // Allocate page-aligned memory
+    a = (double *)alloc_aligned(PAGE_ALIGN, array_size * sizeof(double));
+    b = (double *)alloc_aligned(PAGE_ALIGN, array_size * sizeof(double));
+    c = (double *)alloc_aligned(PAGE_ALIGN, array_size * sizeof(double));
+    
+    if (!a || !b || !c) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    
+    double mem_per_array = (double)(array_size * sizeof(double));
+    double total_mem = mem_per_array * 3;
+    // Reads and writes both start at array a, so a 1:0 pattern touches one array
+    double per_thread_mem = mem_per_array * MAX(MIN(reads, 3), MIN(writes, 3)) / num_threads;
+    double l3_mem = (double)cache_l3_total(cache);
+    char size_buf[32];
+    
+    // Calculate actual DRAM bytes (not logical operations)
+    // Additional reads/writes hit L1 cache and don't contribute to DRAM bandwidth
+    int actual_reads = MIN(reads, 3);
+    int actual_writes = MIN(writes, 3);
+    double total_bytes = pattern_bytes_per_elem(reads, writes) * array_size;
+    
+    printf("════════════════════════════════════════════════════════════\n");
+    printf("  UltraMem - Memory Bandwidth Benchmark\n");
+    printf("════════════════════════════════════════════════════════════\n");
+    printf("  Kernel pattern:    %d:%d (%d reads + %d writes)\n", reads, writes, reads, writes);
+    if (reads > 3 || writes > 3) {
+        printf("  DRAM accesses:     %d:%d (extra ops hit L1 cache)\n", actual_reads, actual_writes);
+    }
+    printf("  Threads:           %d\n", num_threads);
+    printf("  Array elements:    %zu\n", array_size);
+    printf("  Memory per array:  %s\n", format_bytes(size_buf, sizeof(size_buf), mem_per_array));
+    printf("  Total memory:      %s\n", format_bytes(size_buf, sizeof(size_buf), total_mem));
+    printf("  Per-thread set:    %s\n", format_bytes(size_buf, sizeof(size_buf), per_thread_mem));
+    printf("  L3 Cache:          %s\n", format_bytes(size_buf, sizeof(size_buf), l3_mem));
+    printf("  Arrays vs L3:      %.1fx (", total_mem / l3_mem);
+    if (total_mem > l3_mem * 4) {
+        printf("DRAM test ✓)\n");
+    } else if (total_mem > l3_mem) {
+        printf("mostly DRAM)\n");
+    } else if (per_thread_mem <= cache->l1d_size) {
+        printf("L1-resident per thread)\n");
+    } else if (per_thread_mem <= cache->l2_size) {
+        printf("L2-resident per thread)\n");
+    } else {
+        printf("L3-resident)\n");
+    }
+    if (opts.adaptive_ci > 0.0) {
+        printf("  Iterations:        adaptive (median CI <= %.2f%%, %.0f s budget)\n",
+               opts.adaptive_ci * 100, opts.budget);
+    } else {
+        printf("  Iterations:        %d\n", opts.iters);
+    }
+    printf("  Timer:             %s, %.0f ns resolution, %.0f ns/call\n", timer_name(),
+           timer_resolution * 1e9, timer_overhead * 1e9);
+    if (opts.backend == BACKEND_PTHREAD) {
+        printf("  Backend:           pthread team, spin barrier, TSC start\n");
+        printf("  Binding:           %s\n", opts.bind == BIND_NONE ? "core (pthread default)"
+                                                           : bind_policy_name(opts.bind));
+    } else {
+        printf("  Backend:           OpenMP\n");
+        printf("  Binding:           %s\n", bind_policy_name(opts.bind));
+        if (opts.schedule != SCHED_STATIC) {
+            printf("  Schedule:          %s, %zu-byte chunks\n", schedule_name(opts.schedule),
+                   schedule_chunk_elems() * sizeof(double));
+        }
+    }
+    printf("════════════════════════════════════════════════════════════\n\n");
+
+    int actual_threads = 0;
+#if defined(__linux__)
+    if (opts.backend == BACKEND_PTHREAD) {
+        pool_run(POOL_INIT, array_size, 0, 0);
+        actual_threads = pool.num_threads;
+    } else
+#endif
+    {
+        // Initialize arrays in parallel (first touch policy)
+        #pragma omp parallel for simd schedule(static)
+        for (size_t i = 0; i < array_size; i++) {
+            a[i] = 1.0;
+            b[i] = 2.0;
+            c[i] = 0.0;
+        }
+        
+        #pragma omp parallel
+        {
+            #pragma omp single
+            actual_threads = omp_get_num_threads();
+        }
+    }
+    printf("  Actual threads:    %d\n", actual_threads);
+    
+    double dummy_sum = 0.0;
+    long reps = calibrate_reps(array_size, reads, writes, &dummy_sum);
+    total_bytes *= reps;
+    printf("  Inner repeats:     %ld per sample (min %.1f ms)\n\n", reps, SAMPLE_MIN_SEC * 1e3);
+    
+    // Per-iteration records grow with the run in adaptive mode
+    int cap = opts.adaptive_ci > 0.0 ? 64 : opts.iters;
+    double *times = (double *)malloc(cap * sizeof(double));
+    
+    // Per-thread slice times, [iteration][thread]
+    double *thread_times = NULL;
+    if (opts.per_thread) {
+        thread_times = (double *)calloc((size_t)cap * actual_threads, sizeof(double));
+        if (!thread_times) {
+            fprintf(stderr, "Memory allocation failed\n");
+            exit(1);
+        }
+        tsc_ticks_per_sec();
+    }
+#if defined(__linux__)
+    noise_sample_t *noise = opts.noise ? (noise_sample_t *)calloc(cap, sizeof(noise_sample_t)) : NULL;
+    if (opts.noise && !noise) times = NULL;
+#endif
+    if (!times) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+    
+    printf("Running %d:%d benchmark...\n\n", reads, writes);
+    
+#if defined(__linux__)
+    int thread_cpu[MAX_CPUS], thread_moved[MAX_CPUS];
+    for (int t = 0; t < actual_threads; t++) {
+        thread_cpu[t] = -1;
+        thread_moved[t] = 0;
+    }
+    // Snapshots are taken outside the timer, over the CPUs the team is bound to
+    noise_sample_t noise_before;
+    int noise_cpu[MAX_CPUS], noise_ncpu = opts.noise ? noise_bound_cpus(noise_cpu) : 0;
+#endif
+    
+    int ntimes = 0;
+    double started = get_time_sec();
+    for (int k = 0; keep_iterating(times, k, started); k++) {
+        if (k == cap) {
+            cap *= 2;
+            times = (double *)realloc(times, cap * sizeof(double));
+            if (thread_times) {
+                thread_times = (double *)realloc(thread_times, (size_t)cap * actual_threads * sizeof(double));
+            }
+#if defined(__linux__)
+            if (noise) noise = (noise_sample_t *)realloc(noise, cap * sizeof(noise_sample_t));
+            if (opts.noise && !noise) times = NULL;
+#endif
+            if (!times || (opts.per_thread && !thread_times)) {
+                fprintf(stderr, "Memory allocation failed\n");
+                exit(1);
+            }
+        }
+        ntimes = k + 1;
+#if defined(__linux__)
+        if (opts.noise) noise_snapshot(&noise_before, noise_cpu, noise_ncpu);
+        if (opts.backend == BACKEND_PTHREAD) {
+            // Timed between barriers from the team's common start deadline
+            times[k] = pool_run(POOL_KERNEL, array_size, reads, writes);
+            if (opts.noise) {
+                noise_snapshot(&noise[k], noise_cpu, noise_ncpu);
+                noise_delta(&noise[k], &noise_before);
+            }
+            pool_sample_cpus(thread_cpu, thread_moved);
+            for (int t = 0; thread_times && t < actual_threads; t++) {
+                thread_times[k * actual_threads + t] =
+                    (double)(pool.slots[t].end - pool.slots[t].start) / tsc_ticks_per_sec();
+            }
+            continue;
+        }
+#endif
         times[k] = get_time_sec();
-        dummy_sum += kernel_generic(array_size, reads, writes);
+        if (thread_times) {
+            dummy_sum += kernel_per_thread(array_size, reads, writes, reps,
+                                           thread_times + (size_t)k * actual_threads);
+        } else {
+            dummy_sum += kernel_run_reps(array_size, reads, writes, reps);
+        }
         times[k] = get_time_sec() - times[k];
+#if defined(__linux__)
+        if (opts.noise) {
+            noise_snapshot(&noise[k], noise_cpu, noise_ncpu);
+            noise_delta(&noise[k], &noise_before);
+        }
+        // Outside the timed region: where did each thread run this iteration?
+        sample_thread_cpus(actual_threads, thread_cpu, thread_moved);
+#endif
+    }
+    
+#if defined(__linux__)
+    if (opts.backend == BACKEND_PTHREAD) {
+        dummy_sum += pool_sum();
+        pool_stop();
+    }
+#endif
+    
+#if defined(__linux__)
+    printf("Thread placement (thread:cpu, * = migrated during run):\n");
+    for (int t = 0; t < actual_threads; t++) {
+        printf("%s%3d:%-4d%s", t % 8 == 0 ? "  " : "", t, thread_cpu[t],
+               thread_moved[t] ? "*" : " ");
+        if (t % 8 == 7 || t == actual_threads - 1) printf("\n");
+    }
+    printf("\n");
+#endif
+    
+    double avgtime = 0.0;
+    double mintime = times[1];
+    double maxtime = times[1];
+    
+    for (int k = 1; k < ntimes; k++) {
+        avgtime += times[k];
+        mintime = MIN(mintime, times[k]);
+        maxtime = MAX(maxtime, times[k]);
+    }
+    avgtime /= (ntimes - 1);
+    
+    if (mintime < TIMER_MIN_STEPS * timer_resolution && !opts.force) {
+        fprintf(stderr, "Error: best iteration (%.3f us) is under %dx the timer resolution (%.0f ns);\n"
+                        "       use a larger array, or --force to report it anyway\n",
+                mintime * 1e6, TIMER_MIN_STEPS, timer_resolution * 1e9);
+        free(times);
+        free(thread_times);
+#if defined(__linux__)
+        free(noise);
+#endif
+        aligned_free(a);
+        aligned_free(b);
+        aligned_free(c);
+        return 1;
+    }
+    
+    printf("────────────────────────────────────────────────────────────\n");
+    printf("Kernel      Best MB/s    Avg MB/s     Min Time     Max Time\n");
+    printf("────────────────────────────────────────────────────────────\n");
+    
+    double best_bw = total_bytes / mintime / 1e6;
+    double avg_bw = total_bytes / avgtime / 1e6;
+    
+    char label[16];
+    snprintf(label, sizeof(label), "%d:%d", reads, writes);
+    
+    printf("%-8s  %10.1f  %10.1f   %10.6f   %10.6f\n",
+           label, best_bw, avg_bw, mintime, maxtime);
+    
+    printf("────────────────────────────────────────────────────────────\n");
+    printf("\n");
+    
+    // Per-iteration bandwidth: best alone is optimistic and hides bimodal runs
+    double *iter_bw = (double *)malloc((ntimes - 1) * sizeof(double));
+    if (iter_bw) {
+        for (int k = 1; k < ntimes; k++) iter_bw[k - 1] = total_bytes / times[k] / 1e6;
+        stats_t st = compute_stats(iter_bw, ntimes - 1);
+        double ci_lo, ci_hi;
+        bootstrap_median_ci(iter_bw, ntimes - 1, &ci_lo, &ci_hi);
+        printf("Statistics over %d timed iterations (MB/s):\n", ntimes - 1);
+        printf("  Best:        %10.1f   (STREAM-style peak)\n", st.max);
+        printf("  Median:      %10.1f   95%% CI [%.1f, %.1f] (bootstrap, %d resamples)\n",
+               st.median, ci_lo, ci_hi, BOOTSTRAP_RESAMPLES);
+        printf("  Mean:        %10.1f   stddev %.1f, CV %.2f%%\n", st.mean, st.stddev, st.cv * 100);
+        printf("  Percentiles: p5 %.1f  p25 %.1f  p75 %.1f  p95 %.1f\n", st.p5, st.p25, st.p75, st.p95);
+        printf("\n");
+        print_histogram(iter_bw, ntimes - 1, "MB/s");
+        printf("\n");
+        free(iter_bw);
+    }
+    
+    if (opts.adaptive_ci > 0.0) {
+        double ci = median_ci_rel(times + 1, ntimes - 1);
+        printf("%s after %d timed iterations: median 95%% CI ±%.2f%% (target %.2f%%)\n\n",
+               ci <= opts.adaptive_ci ? "Converged" : "Time budget spent", ntimes - 1,
+               ci * 100, opts.adaptive_ci * 100);
+    }
+    
+#if defined(__linux__)
+    if (opts.noise) print_noise_report(noise, times, ntimes, total_bytes);
+#endif
+    
+    // Each OpenMP iteration pays one fork/join inside the timer
+    if (opts.backend == BACKEND_OMP) {
+        double fj = fork_join_cost(FJ_PARALLEL, FJ_REPS / 5);
+        if (mintime < FJ_MARGIN * fj) {
+            printf("⚠ Warning: best iteration (%.1f us) is under %dx the fork/join\n",
+                   mintime * 1e6, FJ_MARGIN);
+            printf("  overhead (%.2f us); use a larger array or --backend=pthread\n\n", fj * 1e6);
+        }
+    }
+    
+    if (thread_times) {
+#if defined(__linux__)
+        print_thread_report(thread_times, ntimes, actual_threads, array_size,
+                            reads, writes, reps, thread_cpu);
+#else
+        print_thread_report(thread_times, ntimes, actual_threads, array_size,
+                            reads, writes, reps, NULL);
+#endif
+        free(thread_times);
+    }
+    
+    printf("════════════════════════════════════════════════════════════\n");
+    printf("  PEAK BANDWIDTH: %.1f MB/s (%.2f GB/s)\n", best_bw, best_bw / 1000.0);
+    printf("════════════════════════════════════════════════════════════\n\n");
+    
+    if (dummy_sum < -1e30) printf("%f", dummy_sum);
+    
+    free(times);
+#if defined(__linux__)
+    free(noise);
+#endif
+    aligned_free(a);
+    aligned_free(b);
+    aligned_free(c);
+    return 0;
+}
+
+// ============================================================================
+// Thread-count scaling sweep (arrays allocated once)
+// ============================================================================
+
+#define MAX_PATTERNS 16
+#define KNEE_FRACTION 0.95
+
+// Parse "1:1,2:1,1:0"; returns the number of patterns, or -1 if invalid
+static int parse_patterns(const char *s, int *reads, int *writes, int max) {
+    int n = 0;
+    while (*s) {
+        int r, w, len;
+        if (n == max || sscanf(s, "%d:%d%n", &r, &w, &len) != 2) return -1;
+        if (r < 0 || r > 100 || w < 0 || w > 100 || (r == 0 && w == 0)) return -1;
+        reads[n] = r;
+        writes[n] = w;
+        n++;
+        s += len;
+        if (*s == ',') s++;
+        else if (*s) return -1;
+    }
+    return n;
+}
+
+// parse_patterns that also takes "latency" entries, stored as -1:-1
+static int parse_victims(const char *s, int *reads, int *writes, int max) {
+    int n = 0;
+    while (*s) {
+        int r = -1, w = -1, len = 7;
+        if (n == max) return -1;
+        if (strncmp(s, "latency", 7) != 0) {
+            if (sscanf(s, "%d:%d%n", &r, &w, &len) != 2) return -1;
+            if (r < 0 || r > 100 || w < 0 || w > 100 || (r == 0 && w == 0)) return -1;
+        }
+        reads[n] = r;
+        writes[n] = w;
+        n++;
+        s += len;
+        if (*s == ',') s++;
+        else if (*s) return -1;
+    }
+    return n;
+}
+
+// Allocate a, b, c and first-touch them with num_threads threads
+static void alloc_arrays(int num_threads, size_t array_size) {
+    a = (double *)alloc_aligned(PAGE_ALIGN, array_size * sizeof(double));
+    b = (double *)alloc_aligned(PAGE_ALIGN, array_size * sizeof(double));
+    c = (double *)alloc_aligned(PAGE_ALIGN, array_size * sizeof(double));
+    if (!a || !b || !c) {
+        fprintf(stderr, "Memory allocation failed\n");
+        exit(1);
+    }
+
+    #pragma omp parallel for simd schedule(static) num_threads(num_threads)
+    for (size_t i = 0; i < array_size; i++) {
+        a[i] = 1.0;
+        b[i] = 2.0;
+        c[i] = 0.0;
+    }
+}
+
+static void free_arrays(void) {
+    aligned_free(a);
+    aligned_free(b);
+    aligned_free(c);
+    a = b = c = NULL;
+}
+
+static int run_thread_sweep(int num_threads, size_t array_size, int reads, int writes) {
+    int pr[MAX_PATTERNS], pw[MAX_PATTERNS], np = 1;
+    pr[0] = reads;
+    pw[0] = writes;
+    if (opts.patterns) np = parse_patterns(opts.patterns, pr, pw, MAX_PATTERNS);
+
+    int counts[MAX_CPUS], nsteps = 0;
+    for (int t = 1; t <= num_threads;
+         t = opts.sweep_linear ? t + 1 : next_pow2_count(t, num_threads)) {
+        counts[nsteps++] = t;
+    }
+
+    double *bw = (double *)calloc((size_t)nsteps * np, sizeof(double));
+    if (!bw) {
+        fprintf(stderr, "Memory allocation failed\n");
+        return 1;
+    }
+
+    // Pin the full team before first touch, as run_benchmark does
+    omp_set_num_threads(num_threads);
+#if defined(__linux__)
+    if (apply_binding(num_threads) != 0) {
+        free(bw);
+        return 1;
+    }
+#endif
+    alloc_arrays(num_threads, array_size);
+
+    printf("════════════════════════════════════════════════════════════\n");
+    printf("  UltraMem - Thread Scaling Sweep\n");
+    printf("════════════════════════════════════════════════════════════\n");
+    printf("  Threads:           1 .. %d (%s)\n", num_threads, opts.sweep_linear ? "linear" : "powers of two");
+    printf("  Memory per array:  %.1f MB\n", (double)(array_size * sizeof(double)) / (1024.0 * 1024.0));
+    printf("  Binding:           %s\n", bind_policy_name(opts.bind));
+    printf("  Iterations:        %d per point (best reported)\n", opts.iters);
+    printf("════════════════════════════════════════════════════════════\n\n");
+
+    printf("────────────────────────────────────────────────────────────\n");
+    printf("Threads");
+    for (int p = 0; p < np; p++) {
+        char label[16];
+        snprintf(label, sizeof(label), "%d:%d", pr[p], pw[p]);
+        printf("  %9s", label);
+    }
+    printf("   (GB/s)\n");
+    printf("────────────────────────────────────────────────────────────\n");
+
+    for (int s = 0; s < nsteps; s++) {
+        omp_set_num_threads(counts[s]);
+#if defined(__linux__)
+        apply_binding(counts[s]);
+#endif
+        printf("%7d", counts[s]);
+        for (int p = 0; p < np; p++) {
+            bw[s * np + p] = kernel_best_bw(array_size, pr[p], pw[p]) / 1000.0;
+            printf("  %9.2f", bw[s * np + p]);
+        }
+        printf("\n");
+        fflush(stdout);
+    }
+    printf("────────────────────────────────────────────────────────────\n");
+
+    // Saturation knee: fewest threads reaching KNEE_FRACTION of the peak
+    int knee[MAX_PATTERNS];
+    printf("%-7s", "Peak");
+    for (int p = 0; p < np; p++) {
+        double peak = 0.0;
+        for (int s = 0; s < nsteps; s++) peak = MAX(peak, bw[s * np + p]);
+        for (knee[p] = 0; bw[knee[p] * np + p] < KNEE_FRACTION * peak; knee[p]++) { }
+        printf("  %9.2f", peak);
+    }
+    printf("\n%-7s", "Knee");
+    for (int p = 0; p < np; p++) printf("  %9d", counts[knee[p]]);
+    printf("   (threads for %.0f%% of peak)\n", KNEE_FRACTION * 100);
+    printf("────────────────────────────────────────────────────────────\n\n");
+
+    free(bw);
+    free_arrays();
+    return 0;
+}
+
+// ============================================================================
+// Working-set sweep: bandwidth and latency from L1 to DRAM
+// ============================================================================
+
+#define SWEEP_MIN_BYTES 4096
+#define SWEEP_STEPS_PER_2X 2    // Points per doubling of the working set
+
+// Which level a single core's working set of this size lives in
+static const char *cache_level(const cache_info_t *cache, size_t bytes) {
+    if (bytes <= cache->l1d_size) return "L1";
+    if (bytes <= cache->l2_size) return "L2";
+    if (bytes <= cache->l3_size) return "L3";
+    return "DRAM";
+}
+
+// Geometric working-set steps from SWEEP_MIN_BYTES to max, on cache-line multiples
+static int sweep_sizes(size_t max, size_t *sizes, int cap) {
+    int n = 0;
+    for (int i = 0; n < cap; i++) {
+        size_t w = (size_t)(SWEEP_MIN_BYTES * pow(2.0, (double)i / SWEEP_STEPS_PER_2X)) & ~(size_t)63;
+        if (w > max) break;
+        sizes[n++] = w;
+    }
+    return n;
+}
+
+// Best GB/s over --iters samples of the first n elements, each sample
+// repeated to SAMPLE_MIN_SEC as in run_benchmark
+static double sweep_bw(size_t n, int reads, int writes) {
+    double sink = 0.0, best = 1e30;
+    long reps = 1;
+    // Calibration samples double as warm-up
+    for (;; reps *= 2) {
+        double t = get_time_sec();
+        sink += kernel_run_reps(n, reads, writes, reps);
+        t = get_time_sec() - t;
+        if (t >= SAMPLE_MIN_SEC || reps >= MAX_REPS) break;
+    }
+    for (int k = 1; k < opts.iters; k++) {
+        double t = get_time_sec();
+        sink += kernel_run_reps(n, reads, writes, reps);
+        best = MIN(best, get_time_sec() - t);
+    }
+    if (sink < -1e30) printf("%f", sink);
+    return pattern_bytes_per_elem(reads, writes) * n * reps / best / 1e9;
+}
+
+// Dependent-load latency in ns over a chain of the given size, after one warm lap
+static double sweep_latency(size_t bytes, size_t line) {
+    void **chain = chase_build(bytes, line);
+    if (!chain) return 0.0;
+    chase_ns(chain, bytes / line);
+    double ns = chase_ns(chain, CHASE_STEPS);
+    aligned_free(chain);
+    return ns;
+}
+
+// Arrays a pattern touches: reads and writes both start at a, so 1:0 uses a
+// alone and the working set of a point is split evenly over these
+static int sweep_touched(int reads, int writes) {
+    return MAX(MIN(reads, 3), MIN(writes, 3));
+}
+
+// Allocate and first-touch only the arrays the patterns use, each just large
+// enough for the biggest point: array j holds max_bytes / k for the smallest
+// k > j among the patterns touching it. Unused arrays stay NULL.
+static int sweep_alloc(int num_threads, size_t max_bytes, const int *pr, const int *pw, int np) {
+    double *x[3] = { NULL, NULL, NULL };
+    int ret = 0;
+    for (int j = 0; j < 3 && ret == 0; j++) {
+        size_t n = 0;
+        for (int p = 0; p < np; p++) {
+            int k = sweep_touched(pr[p], pw[p]);
+            if (k > j) n = MAX(n, max_bytes / k / sizeof(double));
+        }
+        if (n == 0) continue;
+        x[j] = (double *)alloc_aligned(PAGE_ALIGN, n * sizeof(double));
+        if (!x[j]) {
+            ret = -1;
+            break;
+        }
+        double *y = x[j];
+        #pragma omp parallel for simd schedule(static) num_threads(num_threads)
+        for (size_t i = 0; i < n; i++) y[i] = (double)(j + 1);
+    }
+    // Published even on failure, so free_arrays releases what was allocated
+    a = x[0];
+    b = x[1];
+    c = x[2];
+    return ret;
+}
+
+static void print_sweep_boundary(const char *name, size_t bytes) {
+    char size[32];
+    printf("  ── %s %s ──\n", name, format_bytes(size, sizeof(size), (double)bytes));
+}
+
+static int run_size_sweep(int num_threads, size_t array_size, const cache_info_t *cache,
+                          int reads, int writes) {
+    int pr[MAX_PATTERNS], pw[MAX_PATTERNS], np = 1;
+    pr[0] = reads;
+    pw[0] = writes;
+    if (opts.patterns) np = parse_patterns(opts.patterns, pr, pw, MAX_PATTERNS);
+
+    // Up to the memory of all three arrays: 4x the total L3 with the default size
+    size_t max_bytes = array_size * sizeof(double) * 3;
+    int nodes = 1;
+#if defined(__linux__)
+    int node_ids[MAX_CPUS];
+    nodes = MAX(read_cpu_list_file("/sys/devices/system/node/online", node_ids, MAX_CPUS), 1);
+#endif
+    // Past every node's share, so the largest sets also stream from remote memory
+    max_bytes *= nodes;
+
+    size_t sizes[128];
+    int nsizes = sweep_sizes(max_bytes, sizes, 128);
+    int nthreads[2] = { 1, num_threads };
+    int nt = num_threads > 1 ? 2 : 1;
+    int ncols = np * nt;
+
+    int ret = 1;
+    FILE *csv = NULL;
+    double *bw = (double *)malloc(ncols * sizeof(double));
+    if (!bw) {
+        fprintf(stderr, "Memory allocation failed\n");
+        return 1;
+    }
+    if (opts.csv) {
+        csv = fopen(opts.csv, "w");
+        if (!csv) {
+            fprintf(stderr, "Error: cannot open '%s': %s\n", opts.csv, strerror(errno));
+            goto out;
+        }
+    }
+
+    omp_set_num_threads(num_threads);
+#if defined(__linux__)
+    if (apply_binding(num_threads) != 0) goto out;
+#endif
+    if (sweep_alloc(num_threads, max_bytes, pr, pw, np) != 0) {
+        fprintf(stderr, "Memory allocation failed\n");
+        goto out;
+    }
+
+    char size_buf[32];
+    printf("════════════════════════════════════════════════════════════\n");
+    printf("  UltraMem - Working-Set Sweep\n");
+    printf("════════════════════════════════════════════════════════════\n");
+    printf("  Working set:       %s .. ", format_bytes(size_buf, sizeof(size_buf), (double)sizes[0]));
+    printf("%s (%d points, %d per 2x)\n", format_bytes(size_buf, sizeof(size_buf), (double)sizes[nsizes - 1]),
+           nsizes, SWEEP_STEPS_PER_2X);
+    if (nodes > 1) printf("  NUMA nodes:        %d (sweep extended %dx)\n", nodes, nodes);
+    if (nt > 1) printf("  Threads:           1 and %d\n", num_threads);
+    else printf("  Threads:           1\n");
+    printf("  Binding:           %s\n", bind_policy_name(opts.bind));
+    printf("  Iterations:        %d per point (best reported, %.0f ms min sample)\n",
+           opts.iters, SAMPLE_MIN_SEC * 1e3);
+    printf("  Latency:           pointer chase, %zu-byte lines, 1 thread\n", cache->line_size);
+    if (opts.csv) printf("  CSV:               %s\n", opts.csv);
+    printf("════════════════════════════════════════════════════════════\n\n");
+
+    if (csv) fprintf(csv, "working_set_bytes,level,latency_ns");
+    printf("────────────────────────────────────────────────────────────\n");
+    printf("%11s  %5s  %8s", "Set", "Level", "Lat ns");
+    for (int p = 0; p < np; p++) {
+        for (int t = 0; t < nt; t++) {
+            char label[24];
+            snprintf(label, sizeof(label), "%d:%d x%d", pr[p], pw[p], nthreads[t]);
+            printf("  %9s", label);
+            if (csv) fprintf(csv, ",r%dw%d_%dt_gbs", pr[p], pw[p], nthreads[t]);
+        }
+    }
+    printf("   (GB/s)\n");
+    printf("────────────────────────────────────────────────────────────\n");
+    if (csv) fprintf(csv, "\n");
+
+    // Detected boundaries, marked where the sweep crosses them
+    const char *bound_name[4] = { "L1d", "L2", "L3", "L3 total" };
+    size_t bound[4] = { cache->l1d_size, cache->l2_size, cache->l3_size,
+                        cache->l3_domains > 1 ? cache_l3_total(cache) : 0 };
+
+    for (int s = 0; s < nsizes; s++) {
+        for (int k = 0; k < 4; k++) {
+            if (bound[k] && bound[k] < sizes[s] && (s == 0 || bound[k] >= sizes[s - 1])) {
+                print_sweep_boundary(bound_name[k], bound[k]);
+            }
+        }
+
+        for (int t = 0; t < nt; t++) {
+            omp_set_num_threads(nthreads[t]);
+#if defined(__linux__)
+            apply_binding(nthreads[t]);
+#endif
+            for (int p = 0; p < np; p++) {
+                bw[p * nt + t] = sweep_bw(sizes[s] / sweep_touched(pr[p], pw[p]) / sizeof(double),
+                                          pr[p], pw[p]);
+            }
+        }
+        // Latency from a single pinned thread
+        omp_set_num_threads(1);
+#if defined(__linux__)
+        apply_binding(1);
+#endif
+        double lat = sweep_latency(sizes[s], cache->line_size);
+
+        const char *level = cache_level(cache, sizes[s]);
+        printf("%11s  %5s  %8.2f", format_bytes(size_buf, sizeof(size_buf), (double)sizes[s]), level, lat);
+        for (int i = 0; i < ncols; i++) printf("  %9.2f", bw[i]);
+        printf("\n");
+        fflush(stdout);
+        if (csv) {
+            fprintf(csv, "%zu,%s,%.3f", sizes[s], level, lat);
+            for (int i = 0; i < ncols; i++) fprintf(csv, ",%.3f", bw[i]);
+            fprintf(csv, "\n");
+        }
+    }
+    printf("────────────────────────────────────────────────────────────\n\n");
+    ret = 0;
+
+out:
+    free(bw);
+    if (csv) fclose(csv);
+    free_arrays();
+    return ret;
+}
+
+// ============================================================================
+// SMT placement: one thread per physical core vs packed onto siblings
+// ============================================================================
+
+#if defined(__linux__)
+static void print_cpu_plan(const char *label, const int *cpus, int n) {
+    printf("  %-19s", label);
+    for (int i = 0; i < n; i++) {
+        if (i == 16) {
+            printf(" ...");
+            break;
+        }
+        printf("%s%d", i ? "," : "", cpus[i]);
+    }
+    printf("\n");
+}
+
+static int run_smt(int num_threads, size_t array_size, int reads, int writes) {
+    int pr[MAX_PATTERNS], pw[MAX_PATTERNS], np = 1;
+    pr[0] = reads;
+    pw[0] = writes;
+    if (opts.patterns) np = parse_patterns(opts.patterns, pr, pw, MAX_PATTERNS);
+
+    detect_topology();
+    int cores = 0, width = 1;
+    for (int i = 0; i < topo.num_cpus; i++) {
+        if (topo.cpus[i].smt_leader == topo.cpus[i].cpu) cores++;
+        width = MAX(width, topo.cpus[i].smt_width);
+    }
+
+    static const bind_policy_t policies[2] = { BIND_CORE, BIND_COMPACT };
+    int plans[2][MAX_CPUS];
+    for (int k = 0; k < 2; k++) {
+        if (binding_plan(policies[k], NULL, num_threads, plans[k]) < 0) return 1;
+    }
+
+    printf("════════════════════════════════════════════════════════════\n");
+    printf("  UltraMem - SMT Placement Comparison\n");
+    printf("════════════════════════════════════════════════════════════\n");
+    printf("  Threads:           %d\n", num_threads);
+    printf("  Physical cores:    %d (%d logical CPUs, up to %d per core)\n",
+           cores, topo.num_cpus, width);
+    print_cpu_plan("One per core:", plans[0], num_threads);
+    print_cpu_plan("SMT packed:", plans[1], num_threads);
+    printf("  Memory per array:  %.1f MB\n", (double)(array_size * sizeof(double)) / (1024.0 * 1024.0));
+    printf("════════════════════════════════════════════════════════════\n\n");
+    if (width == 1) {
+        printf("Note: no SMT siblings available, both placements are identical\n\n");
+    } else if (num_threads > cores) {
+        printf("Note: %d threads exceed %d cores, one-per-core also uses siblings\n\n",
+               num_threads, cores);
+    }
+
+    double bw[2][MAX_PATTERNS];
+    for (int k = 0; k < 2; k++) {
+        // Fresh arrays per placement so first touch follows the pinning
+        omp_set_num_threads(num_threads);
+        bind_team(policies[k], NULL, num_threads);
+        alloc_arrays(num_threads, array_size);
+        for (int p = 0; p < np; p++) bw[k][p] = kernel_best_bw(array_size, pr[p], pw[p]) / 1000.0;
+        free_arrays();
+    }
+
+    printf("────────────────────────────────────────────────────────────\n");
+    printf("Pattern    One/core GB/s   Packed GB/s   Packed vs one/core\n");
+    printf("────────────────────────────────────────────────────────────\n");
+    for (int p = 0; p < np; p++) {
+        char label[16];
+        snprintf(label, sizeof(label), "%d:%d", pr[p], pw[p]);
+        printf("%-8s  %14.2f  %12.2f   %+17.1f%%\n", label, bw[0][p], bw[1][p],
+               100.0 * (bw[1][p] / bw[0][p] - 1.0));
+    }
+    printf("────────────────────────────────────────────────────────────\n\n");
+    return 0;
+}
+#else
+static int run_smt(int num_threads, size_t array_size, int reads, int writes) {
+    (void)num_threads; (void)array_size; (void)reads; (void)writes;
+    fprintf(stderr, "Error: --mode=smt requires Linux\n");
+    return 1;
+}
+#endif
+
+// ============================================================================
+// Per-L3-domain bandwidth (CCX / sub-NUMA cluster) and scaling across domains
+// ============================================================================
+
+#if defined(__linux__)
+// Pin n threads to plan, first-touch fresh arrays and measure every pattern
+static void domain_team_bw(const int *plan, int n, size_t array_size,
+                           const int *pr, const int *pw, int np, double *out) {
+    omp_set_num_threads(n);
+    pin_team(plan, n);
+    alloc_arrays(n, array_size);
+    for (int p = 0; p < np; p++) out[p] = kernel_best_bw(array_size, pr[p], pw[p]) / 1000.0;
+    free_arrays();
+}
+
+static int run_l3domains(int num_threads, size_t array_size, int reads, int writes) {
+    int pr[MAX_PATTERNS], pw[MAX_PATTERNS], np = 1;
+    pr[0] = reads;
+    pw[0] = writes;
+    if (opts.patterns) np = parse_patterns(opts.patterns, pr, pw, MAX_PATTERNS);
+
+    detect_topology();
+    int domains[MAX_CPUS];
+    int ndom = topology_l3_domains(domains);
+    if (ndom == 0) {
+        fprintf(stderr, "Error: no CPUs available\n");
+        return 1;
+    }
+
+    // Up to num_threads CPUs from each domain, one per core first
+    static int members[MAX_CPUS][MAX_CPUS];
+    int count[MAX_CPUS];
+    for (int d = 0; d < ndom; d++) {
+        count[d] = MIN(topology_domain_cpus(domains[d], members[d]), num_threads);
+    }
+
+    printf("════════════════════════════════════════════════════════════\n");
+    printf("  UltraMem - L3 Domain Bandwidth\n");
+    printf("════════════════════════════════════════════════════════════\n");
+    printf("  L3 domains:        %d\n", ndom);
+    printf("  Threads/domain:    up to %d\n", num_threads);
+    printf("  Memory per array:  %.1f MB\n", (double)(array_size * sizeof(double)) / (1024.0 * 1024.0));
+    for (int d = 0; d < ndom; d++) {
+        char label[32];
+        snprintf(label, sizeof(label), "Domain %d:", d);
+        print_cpu_plan(label, members[d], count[d]);
+    }
+    printf("════════════════════════════════════════════════════════════\n\n");
+
+    printf("One domain at a time\n");
+    printf("────────────────────────────────────────────────────────────\n");
+    printf("Domain  Threads");
+    for (int p = 0; p < np; p++) {
+        char label[16];
+        snprintf(label, sizeof(label), "%d:%d", pr[p], pw[p]);
+        printf("  %9s", label);
+    }
+    printf("   (GB/s)\n");
+    printf("────────────────────────────────────────────────────────────\n");
+    double bw[MAX_PATTERNS], single[MAX_PATTERNS] = {0};
+    for (int d = 0; d < ndom; d++) {
+        domain_team_bw(members[d], count[d], array_size, pr, pw, np, bw);
+        printf("%6d  %7d", d, count[d]);
+        for (int p = 0; p < np; p++) {
+            printf("  %9.2f", bw[p]);
+            if (d == 0) single[p] = bw[p];
+        }
+        printf("\n");
+        fflush(stdout);
+    }
+    printf("────────────────────────────────────────────────────────────\n\n");
+
+    printf("Adding domains (efficiency vs domain 0 times the domain count)\n");
+    printf("────────────────────────────────────────────────────────────\n");
+    printf("Domains Threads");
+    for (int p = 0; p < np; p++) {
+        char label[16];
+        snprintf(label, sizeof(label), "%d:%d", pr[p], pw[p]);
+        printf("  %9s   eff", label);
+    }
+    printf("\n");
+    printf("────────────────────────────────────────────────────────────\n");
+    int plan[MAX_CPUS], n = 0;
+    for (int d = 0; d < ndom; d++) {
+        for (int i = 0; i < count[d]; i++) plan[n++] = members[d][i];
+        domain_team_bw(plan, n, array_size, pr, pw, np, bw);
+        printf("%7d %7d", d + 1, n);
+        for (int p = 0; p < np; p++) {
+            printf("  %9.2f  %3.0f%%", bw[p], 100.0 * bw[p] / (single[p] * (d + 1)));
+        }
+        printf("\n");
+        fflush(stdout);
+    }
+    printf("────────────────────────────────────────────────────────────\n\n");
+    return 0;
+}
+#else
+static int run_l3domains(int num_threads, size_t array_size, int reads, int writes) {
+    (void)num_threads; (void)array_size; (void)reads; (void)writes;
+    fprintf(stderr, "Error: --mode=l3domains requires Linux\n");
+    return 1;
+}
+#endif
+
+// ============================================================================
+// Interference matrix: victim group vs aggressor group on disjoint CPUs
+// ============================================================================
+
+#if defined(__linux__)
+#define INTERF_LAT_REPEATS 5
+
+// Aggressor group: its own OpenMP team (a separate pthread gets its own
+// libgomp pool) streaming its own arrays until told to stop
+typedef struct {
+    const int *cpus;
+    int threads;
+    int reads, writes;
+    size_t n;
+    volatile int stop;
+    int ready;
+} aggressor_t;
+
+static void *aggressor_main(void *arg) {
+    aggressor_t *g = (aggressor_t *)arg;
+    double *x = (double *)alloc_aligned(ALIGN, g->n * sizeof(double));
+    double *y = (double *)alloc_aligned(ALIGN, g->n * sizeof(double));
+    double *z = (double *)alloc_aligned(ALIGN, g->n * sizeof(double));
+    double sink = 0.0;
+
+    if (x && y && z) {
+        omp_set_num_threads(g->threads);
+        pin_team(g->cpus, g->threads);
+        #pragma omp parallel for simd schedule(static)
+        for (size_t i = 0; i < g->n; i++) {
+            x[i] = 1.0;
+            y[i] = 2.0;
+            z[i] = 0.0;
+        }
+    }
+    __atomic_store_n(&g->ready, 1, __ATOMIC_RELEASE);
+    while (x && y && z && !g->stop) sink += kernel_arrays(x, y, z, g->n, g->reads, g->writes);
+    if (sink < -1e30) printf("%f", sink);
+
+    if (x) aligned_free(x);
+    if (y) aligned_free(y);
+    if (z) aligned_free(z);
+    return NULL;
+}
+
+// Victim metric: mean GB/s of its pattern, or mean ns per dependent load
+static double victim_measure(int latency, void **chain, size_t n, int reads, int writes) {
+    double total = 0.0, sink = 0.0;
+    if (latency) {
+        for (int k = 0; k < INTERF_LAT_REPEATS; k++) total += chase_ns(chain, CHASE_STEPS);
+        return total / INTERF_LAT_REPEATS;
+    }
+    for (int k = 0; k < opts.iters; k++) {
+        double t = get_time_sec();
+        sink += kernel_generic(n, reads, writes);
+        t = get_time_sec() - t;
+        if (k > 0) total += t;
+    }
+    if (sink < -1e30) printf("%f", sink);
+    return 1.0E-09 * pattern_bytes_per_elem(reads, writes) * n / (total / (opts.iters - 1));
+}
+
+// One victim against every aggressor pattern and thread count. The victim
+// group takes the first CPUs in core order, the aggressors the rest.
+static int interfere_victim(int num_threads, size_t array_size, int vr, int vw,
+                            const int *pr, const int *pw, int np, const int *order, int total) {
+    int latency = vr < 0;
+    int victims = latency ? 1 : MIN(num_threads, total - 1);
+    int max_aggr = total - victims;
+    const int *aggr_cpus = order + victims;
+
+    omp_set_num_threads(victims);
+    pin_team(order, victims);
+    void **chain = NULL;
+    if (latency) {
+        chain = chase_build(array_size * sizeof(double), 64);
+        if (!chain) {
+            fprintf(stderr, "Memory allocation failed\n");
+            return 1;
+        }
+        pin_to_cpu(order[0]);
+    } else {
+        alloc_arrays(victims, array_size);
+    }
+
+    if (latency) {
+        printf("Victim: pointer-chase latency, %.1f MB working set\n",
+               (double)(array_size * sizeof(double)) / (1024.0 * 1024.0));
+    } else {
+        printf("Victim: %d:%d, %d threads%s\n", vr, vw, victims,
+               victims < num_threads ? " (capped to leave CPUs for the aggressors)" : "");
+    }
+    print_cpu_plan("Victim CPUs:", order, victims);
+    print_cpu_plan("Aggressor CPUs:", aggr_cpus, max_aggr);
+
+    double base = victim_measure(latency, chain, array_size, vr, vw);
+    const char *unit = latency ? "ns" : "GB/s";
+
+    printf("────────────────────────────────────────────────────────────\n");
+    printf("Aggressor");
+    for (int p = 0; p < np; p++) {
+        char label[16];
+        snprintf(label, sizeof(label), "vs %d:%d", pr[p], pw[p]);
+        printf("  %9s  %6s", label, "delta");
+    }
+    printf("   (victim %s)\n", unit);
+    printf("────────────────────────────────────────────────────────────\n");
+    printf("%9d", 0);
+    for (int p = 0; p < np; p++) printf("  %9.2f  %6s", base, "-");
+    printf("\n");
+    fflush(stdout);
+
+    int ret = 0;
+    for (int t = 1; t <= max_aggr && ret == 0; t = next_pow2_count(t, max_aggr)) {
+        printf("%9d", t);
+        for (int p = 0; p < np; p++) {
+            aggressor_t g = { aggr_cpus, t, pr[p], pw[p], array_size, 0, 0 };
+            pthread_t tid;
+            if (pthread_create(&tid, NULL, aggressor_main, &g) != 0) {
+                fprintf(stderr, "\nError: cannot start aggressor group\n");
+                ret = 1;
+                break;
+            }
+            unsigned spins = 0;
+            while (!__atomic_load_n(&g.ready, __ATOMIC_ACQUIRE)) spin_relax(&spins);
+            double v = victim_measure(latency, chain, array_size, vr, vw);
+            g.stop = 1;
+            pthread_join(tid, NULL);
+            printf("  %9.2f  %+5.0f%%", v, 100.0 * (v / base - 1.0));
+            fflush(stdout);
+        }
+        printf("\n");
+    }
+    printf("────────────────────────────────────────────────────────────\n\n");
+
+    if (latency) aligned_free(chain);
+    else free_arrays();
+    return ret;
+}
+
+static int run_interfere(int num_threads, size_t array_size, int reads, int writes) {
+    // Victims: --victim list (patterns and/or latency); aggressors: --patterns
+    int vr[MAX_PATTERNS], vw[MAX_PATTERNS], nv = 1;
+    vr[0] = reads;
+    vw[0] = writes;
+    if (opts.victim) nv = parse_victims(opts.victim, vr, vw, MAX_PATTERNS);
+    int pr[MAX_PATTERNS], pw[MAX_PATTERNS], np = 1;
+    pr[0] = reads;
+    pw[0] = writes;
+    if (opts.patterns) np = parse_patterns(opts.patterns, pr, pw, MAX_PATTERNS);
+
+    // Victim and aggressors never share a CPU: sharing would measure the scheduler
+    detect_topology();
+    int order[MAX_CPUS];
+    int total = topology_core_order(order);
+    if (total < 2) {
+        fprintf(stderr, "Error: --mode=interfere needs at least 2 CPUs (victim and aggressors)\n");
+        return 1;
+    }
+
+    printf("════════════════════════════════════════════════════════════\n");
+    printf("  UltraMem - Interference Matrix\n");
+    printf("════════════════════════════════════════════════════════════\n");
+    printf("  Victims:           %d (%s)\n", nv, opts.victim ? opts.victim : "the pattern");
+    printf("  Aggressors:        %d pattern%s, 1, 2, 4 .. spare CPUs\n", np, np == 1 ? "" : "s");
+    printf("  Memory per array:  %.1f MB (each group)\n", (double)(array_size * sizeof(double)) / (1024.0 * 1024.0));
+    printf("════════════════════════════════════════════════════════════\n\n");
+
+    for (int v = 0; v < nv; v++) {
+        if (interfere_victim(num_threads, array_size, vr[v], vw[v], pr, pw, np, order, total) != 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+#else
+static int run_interfere(int num_threads, size_t array_size, int reads, int writes) {
+    (void)num_threads; (void)array_size; (void)reads; (void)writes;
+    fprintf(stderr, "Error: --mode=interfere requires Linux\n");
+    return 1;
+}
+#endif
+
+// ============================================================================
+// Rate-limited load generator: per-thread token buckets
+// ============================================================================
+
+#if defined(__linux__)
+#define LOADGEN_CHUNK 8192      // Elements per array per grant (64 KB)
+#define LOADGEN_BURST 4         // Bucket depth in chunks
+#define LOADGEN_TOLERANCE 0.05  // Interval counts as on target within +-5%
+
+typedef struct {
+    __attribute__((aligned(64))) uint64_t bytes;   // Bytes moved so far
+} loadgen_slot_t;
+
+static loadgen_slot_t loadgen_slots[MAX_CPUS];
+
+static uint64_t loadgen_total(int nt) {
+    uint64_t sum = 0;
+    for (int t = 0; t < nt; t++) sum += __atomic_load_n(&loadgen_slots[t].bytes, __ATOMIC_RELAXED);
+    return sum;
+}
+
+static void loadgen_report(double at, double gbs) {
+    if (opts.rate_gbs > 0) {
+        printf("%6.2f   %11.2f   %13.2f   %14.1f%%\n", at, opts.rate_gbs, gbs,
+               100.0 * gbs / opts.rate_gbs);
+    } else {
+        printf("%6.2f   %11s   %13.2f   %15s\n", at, "-", gbs, "-");
+    }
+    fflush(stdout);
+}
+
+// Per-second series, sampled by a thread of its own so the reports do not
+// wait on a generator sleeping for its tokens
+typedef struct {
+    int nt, seconds;
+    double ticks;
+    uint64_t start;
+    double *interval;       // Achieved GB/s of each report
+    int reports;
+    uint64_t reported;      // Bytes at the previous report
+    uint64_t last;          // TSC of the previous report
+} loadgen_reporter_t;
+
+// Close the interval ending at TSC now, dividing by its measured length
+static void loadgen_sample(loadgen_reporter_t *r, uint64_t now) {
+    uint64_t bytes = loadgen_total(r->nt);
+    double secs = (now - r->last) / r->ticks;
+    r->interval[r->reports] = secs > 0 ? (bytes - r->reported) / secs / 1e9 : 0.0;
+    loadgen_report((now - r->start) / r->ticks, r->interval[r->reports]);
+    r->reports++;
+    r->reported = bytes;
+    r->last = now;
+}
+
+// Reports at every whole second but the last, which closes when the team ends
+static void *loadgen_reporter(void *arg) {
+    loadgen_reporter_t *r = (loadgen_reporter_t *)arg;
+    for (int i = 1; i < r->seconds; i++) {
+        uint64_t due = r->start + (uint64_t)(i * r->ticks), now;
+        while ((now = tsc_now()) < due) {
+            double left = (due - now) / r->ticks;
+            struct timespec ts = { (time_t)left, (long)((left - (time_t)left) * 1e9) };
+            nanosleep(&ts, NULL);
+        }
+        loadgen_sample(r, now);
+    }
+    return NULL;
+}
+
+static int run_loadgen(int num_threads, size_t array_size, int reads, int writes) {
+    double target = opts.rate_gbs * 1e9;   // Bytes per second, 0 = unlimited
+    int seconds = opts.duration > 0 ? (int)opts.duration : 10;
+    double bpe = pattern_bytes_per_elem(reads, writes);
+
+    omp_set_num_threads(num_threads);
+    if (apply_binding(num_threads) != 0) return 1;
+    alloc_arrays(num_threads, array_size);
+    double *interval = (double *)calloc((size_t)seconds + 1, sizeof(double));
+    if (!interval) {
+        fprintf(stderr, "Memory allocation failed\n");
+        free_arrays();
+        return 1;
+    }
+
+    printf("════════════════════════════════════════════════════════════\n");
+    printf("  UltraMem - Rate-Limited Load Generator\n");
+    printf("════════════════════════════════════════════════════════════\n");
+    printf("  Kernel pattern:    %d:%d\n", reads, writes);
+    printf("  Threads:           %d\n", num_threads);
+    printf("  Binding:           %s\n", bind_policy_name(opts.bind));
+    if (target > 0) {
+        printf("  Target:            %.2f GB/s (%.3f GB/s per thread)\n",
+               opts.rate_gbs, opts.rate_gbs / num_threads);
+    } else {
+        printf("  Target:            unlimited\n");
+    }
+    printf("  Token bucket:      %zu KB grants, %d grants deep\n",
+           (size_t)(LOADGEN_CHUNK * bpe) / 1024, LOADGEN_BURST);
+    printf("  Duration:          %d s\n", seconds);
+    printf("  Memory per array:  %.1f MB\n", (double)(array_size * sizeof(double)) / (1024.0 * 1024.0));
+    printf("════════════════════════════════════════════════════════════\n\n");
+
+    printf("────────────────────────────────────────────────────────────\n");
+    printf("  Time   Target GB/s   Achieved GB/s   Achieved/Target\n");
+    printf("────────────────────────────────────────────────────────────\n");
+    fflush(stdout);
+
+    double ticks = tsc_ticks_per_sec();
+    double sink = 0.0;
+    for (int t = 0; t < num_threads; t++) loadgen_slots[t].bytes = 0;
+    uint64_t start = tsc_now();
+    uint64_t end = start + (uint64_t)(seconds * ticks);
+
+    loadgen_reporter_t rep = { num_threads, seconds, ticks, start, interval, 0, 0, start };
+    pthread_t reporter;
+    if (pthread_create(&reporter, NULL, loadgen_reporter, &rep) != 0) {
+        fprintf(stderr, "Error: pthread_create: %s\n", strerror(errno));
+        free(interval);
+        free_arrays();
+        return 1;
+    }
+
+    #pragma omp parallel reduction(+:sink)
+    {
+        int tid = omp_get_thread_num(), nt = omp_get_num_threads();
+        size_t lo, hi;
+        thread_slice(tid, nt, array_size, &lo, &hi);
+        double rate = target / nt;
+        double grant = LOADGEN_CHUNK * bpe;
+        double tokens = grant;
+        uint64_t last = tsc_now();
+        size_t pos = lo;
+
+        for (;;) {
+            uint64_t now = tsc_now();
+            if (now >= end) break;
+
+            if (target > 0) {
+                // Refill, capped so an idle stretch cannot turn into a burst
+                tokens = MIN(tokens + (now - last) / ticks * rate, LOADGEN_BURST * grant);
+                last = now;
+                if (tokens < grant) {
+                    double wait = (grant - tokens) / rate;
+                    if (wait > 100e-6) {
+                        struct timespec ts = { 0, (long)((wait - 50e-6) * 1e9) };
+                        nanosleep(&ts, NULL);
+                    } else {
+                        unsigned spins = 0;
+                        spin_relax(&spins);
+                    }
+                    continue;
+                }
+            }
+            if (hi <= lo) continue;
+
+            size_t stop = MIN(pos + LOADGEN_CHUNK, hi);
+            sink += kernel_slice(pos, stop, reads, writes);
+            tokens -= (stop - pos) * bpe;
+            __atomic_store_n(&loadgen_slots[tid].bytes,
+                             loadgen_slots[tid].bytes + (uint64_t)((stop - pos) * bpe), __ATOMIC_RELAXED);
+            pos = stop == hi ? lo : stop;
+        }
+    }
+    // The last interval ends with the team
+    uint64_t finished = tsc_now();
+    pthread_join(reporter, NULL);
+    loadgen_sample(&rep, finished);
+    int reports = rep.reports;
+    printf("────────────────────────────────────────────────────────────\n");
+
+    double elapsed = (finished - start) / ticks;
+    double avg = loadgen_total(num_threads) / elapsed / 1e9;
+    double lo = 0.0, hi = 0.0;
+    int on_target = 0;
+    for (int i = 0; i < reports; i++) {
+        lo = i == 0 ? interval[i] : MIN(lo, interval[i]);
+        hi = MAX(hi, interval[i]);
+        double miss = interval[i] - opts.rate_gbs;
+        if (miss < 0) miss = -miss;
+        if (miss <= LOADGEN_TOLERANCE * opts.rate_gbs) on_target++;
+    }
+    printf("  Average:           %.2f GB/s over %.1f s\n", avg, elapsed);
+    printf("  Interval range:    %.2f .. %.2f GB/s\n", lo, hi);
+    if (target > 0) {
+        printf("  On target (±%.0f%%): %d of %d intervals\n", LOADGEN_TOLERANCE * 100,
+               on_target, reports);
+    }
+    printf("\n");
+
+    if (sink < -1e30) printf("%f", sink);
+    free(interval);
+    free_arrays();
+    return 0;
+}
+#else
+static int run_loadgen(int num_threads, size_t array_size, int reads, int writes) {
+    (void)num_threads; (void)array_size; (void)reads; (void)writes;
+    fprintf(stderr, "Error: --mode=loadgen requires Linux\n");
+    return 1;
+}
+#endif
+
+// ============================================================================
+// Duration runs: bandwidth / frequency time series and throttling detection
+// ============================================================================
+
+#define SERIES_INTERVAL 1.0     // Seconds per time-series sample
+#define CP_WINDOW 5             // Samples on each side of a change point
+#define CP_DROP 0.05            // Minimum sustained drop to report
+
+// Mean scaling_cur_freq (MHz) of the given CPUs, 0 when unavailable
+static double cpu_freq_mhz(const int *cpus, int n) {
+#if defined(__linux__)
+    double sum = 0.0;
+    int count = 0;
+    for (int i = 0; i < n; i++) {
+        char path[128];
+        int khz;
+        snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cpufreq/scaling_cur_freq", cpus[i]);
+        if (cpus[i] >= 0 && read_int_file(path, &khz) == 0) {
+            sum += khz / 1000.0;
+            count++;
+        }
+    }
+    return count ? sum / count : 0.0;
+#else
+    (void)cpus; (void)n;
+    return 0.0;
+#endif
+}
+
+static double median_of(const double *v, int n) {
+    double tmp[CP_WINDOW];
+    memcpy(tmp, v, n * sizeof(double));
+    qsort(tmp, n, sizeof(double), cmp_double);
+    return n % 2 ? tmp[n / 2] : 0.5 * (tmp[n / 2 - 1] + tmp[n / 2]);
+}
+
+// Relative drop from the CP_WINDOW samples before i to the CP_WINDOW from i.
+// Medians make a single slow sample unable to fake a sustained drop.
+static double series_drop(const double *v, int i) {
+    double before = median_of(v + i - CP_WINDOW, CP_WINDOW);
+    double after = median_of(v + i, CP_WINDOW);
+    return before > 0.0 ? 1.0 - after / before : 0.0;
+}
+
+static int run_duration(int num_threads, size_t array_size, int reads, int writes) {
+    int max_samples = (int)(opts.duration / SERIES_INTERVAL) + 2;
+    double *bw = (double *)calloc(max_samples, sizeof(double));
+    double *mhz = (double *)calloc(max_samples, sizeof(double));
+    double *when = (double *)calloc(max_samples, sizeof(double));   // Sample start, s
+    int ret = 1;
+    if (!bw || !mhz || !when) {
+        fprintf(stderr, "Memory allocation failed\n");
+        goto out;
+    }
+    double bpe = pattern_bytes_per_elem(reads, writes);
+
+    omp_set_num_threads(num_threads);
+#if defined(__linux__)
+    if (apply_binding(num_threads) != 0) goto out;
+#endif
+    alloc_arrays(num_threads, array_size);
+
+    printf("════════════════════════════════════════════════════════════\n");
+    printf("  UltraMem - Duration Run\n");
+    printf("════════════════════════════════════════════════════════════\n");
+    printf("  Kernel pattern:    %d:%d\n", reads, writes);
+    printf("  Threads:           %d\n", num_threads);
+    printf("  Memory per array:  %.1f MB\n", (double)(array_size * sizeof(double)) / (1024.0 * 1024.0));
+    printf("  Duration:          %.0f s, %.0f s samples\n", opts.duration, SERIES_INTERVAL);
+    if (opts.schedule != SCHED_STATIC) {
+        printf("  Schedule:          %s, %zu-byte chunks\n", schedule_name(opts.schedule),
+               schedule_chunk_elems() * sizeof(double));
+    }
+    printf("  Change points:     >= %.0f%% median drop over %d samples\n", CP_DROP * 100, CP_WINDOW);
+    printf("════════════════════════════════════════════════════════════\n\n");
+
+    printf("────────────────────────────────────────────────────────────\n");
+    printf("  Time(s)   Iters        GB/s     Avg MHz\n");
+    printf("────────────────────────────────────────────────────────────\n");
+    fflush(stdout);
+
+    int cpus[MAX_CPUS];
+    for (int t = 0; t < num_threads; t++) cpus[t] = -1;
+    double sink = 0.0;
+    int n = 0;
+    double start = get_time_sec(), mark = start;
+    double bytes = 0.0;
+    int iters = 0;
+
+    // Warm-up iteration outside the series, as in run_benchmark
+    sink += kernel_run(array_size, reads, writes, NULL);
+    start = mark = get_time_sec();
+    while (n < max_samples) {
+        sink += kernel_run(array_size, reads, writes, NULL);
+        bytes += bpe * array_size;
+        iters++;
+        double now = get_time_sec();
+        if (now - mark < SERIES_INTERVAL) continue;
+
+#if defined(__linux__)
+        sample_thread_cpus(num_threads, cpus, NULL);
+#endif
+        when[n] = mark - start;
+        bw[n] = bytes / (now - mark) / 1e9;
+        mhz[n] = cpu_freq_mhz(cpus, num_threads);
+        printf("%9.1f  %6d  %10.2f  ", now - start, iters, bw[n]);
+        if (mhz[n] > 0.0) printf("%10.0f\n", mhz[n]);
+        else printf("%10s\n", "-");
+        fflush(stdout);
+        n++;
+        bytes = 0.0;
+        iters = 0;
+        mark = get_time_sec();
+        if (mark - start >= opts.duration) break;
+    }
+    printf("────────────────────────────────────────────────────────────\n");
+
+    double lo = bw[0], hi = bw[0], mean = 0.0;
+    for (int i = 0; i < n; i++) {
+        lo = MIN(lo, bw[i]);
+        hi = MAX(hi, bw[i]);
+        mean += bw[i] / n;
+    }
+    printf("  Bandwidth:         mean %.2f, min %.2f, max %.2f GB/s\n", mean, lo, hi);
+
+    // Change points: largest sustained drop within each +-CP_WINDOW neighbourhood
+    int found = 0;
+    for (int i = CP_WINDOW; i + CP_WINDOW <= n; i++) {
+        double drop = series_drop(bw, i);
+        if (drop < CP_DROP) continue;
+        int peak = 1;
+        for (int j = MAX(CP_WINDOW, i - CP_WINDOW); j <= MIN(n - CP_WINDOW, i + CP_WINDOW); j++) {
+            if (j != i && (series_drop(bw, j) > drop || (series_drop(bw, j) == drop && j < i))) peak = 0;
+        }
+        if (!peak) continue;
+
+        double bw_before = median_of(bw + i - CP_WINDOW, CP_WINDOW);
+        double bw_after = median_of(bw + i, CP_WINDOW);
+        printf("  ⚠ Sustained drop at %.1f s: %.2f -> %.2f GB/s (-%.1f%%)",
+               when[i], bw_before, bw_after, drop * 100);
+        double f_before = median_of(mhz + i - CP_WINDOW, CP_WINDOW);
+        double f_after = median_of(mhz + i, CP_WINDOW);
+        if (f_before > 0.0) printf(", CPU %.0f -> %.0f MHz", f_before, f_after);
+        printf("\n");
+        found++;
+    }
+    if (!found) {
+        printf("  Throttling:        no sustained drop >= %.0f%%%s\n", CP_DROP * 100,
+               n < 2 * CP_WINDOW ? " (run too short to tell)" : "");
+    }
+    printf("\n");
+
+    if (sink < -1e30) printf("%f", sink);
+    ret = 0;
+out:
+    free(bw);
+    free(mhz);
+    free(when);
+    free_arrays();
+    return ret;
+}
+
+// ============================================================================
+// Low-noise mode: real-time priority, locked memory, isolated CPUs
+// ============================================================================
+
+#if defined(__linux__)
+#define LOWNOISE_WARMUP 3       // Extra untimed passes to settle caches and TLBs
+#define LOWNOISE_TRIM_DEFAULT (128 * 1024)   // glibc's M_TRIM_THRESHOLD default
+
+// Bandwidth (MB/s) of iterations 1..iters-1 after `warmup` untimed passes
+static void lownoise_measure(size_t n, int reads, int writes, int warmup, double *bw) {
+    double sink = 0.0;
+    for (int k = 0; k < warmup; k++) sink += kernel_generic(n, reads, writes);
+    for (int k = 0; k < opts.iters; k++) {
+        double t = get_time_sec();
+        sink += kernel_generic(n, reads, writes);
+        t = get_time_sec() - t;
+        if (k > 0) bw[k - 1] = pattern_bytes_per_elem(reads, writes) * n / t / 1e6;
+    }
+    if (sink < -1e30) printf("%f", sink);
+}
+
+static void print_lownoise_row(const char *label, const double *bw) {
+    stats_t s = compute_stats(bw, opts.iters - 1);
+    printf("%-10s  %10.1f  %10.1f  %9.1f  %6.2f%%  %10.1f\n", label, s.max, s.mean,
+           s.stddev, s.cv * 100, s.max - s.min);
+}
+
+static int run_lownoise(int num_threads, size_t array_size, int reads, int writes) {
+    char fifo[96], mlock_status[96], cpus_status[128], thp[96], trim[96];
+    double *bw_default = (double *)calloc(opts.iters, sizeof(double));
+    double *bw_quiet = (double *)calloc(opts.iters, sizeof(double));
+    if (!bw_default || !bw_quiet) {
+        fprintf(stderr, "Memory allocation failed\n");
+        return 1;
+    }
+
+    // Reference: a plain run with the usual --bind handling
+    omp_set_num_threads(num_threads);
+    if (apply_binding(num_threads) != 0) {
+        free(bw_default);
+        free(bw_quiet);
+        return 1;
+    }
+    alloc_arrays(num_threads, array_size);
+    lownoise_measure(array_size, reads, writes, 0, bw_default);
+    free_arrays();
+
+    // glibc returns freed heap top to the kernel; re-faulting it later is noise
+#if defined(M_TRIM_THRESHOLD)
+    snprintf(trim, sizeof(trim), mallopt(M_TRIM_THRESHOLD, -1) ? "applied (M_TRIM_THRESHOLD = -1)"
+                                                               : "failed");
+#else
+    snprintf(trim, sizeof(trim), "unavailable (not glibc)");
+#endif
+
+    // No transparent huge pages for our mappings: no compaction stalls on fault
+    if (prctl(PR_SET_THP_DISABLE, 1, 0, 0, 0) == 0) snprintf(thp, sizeof(thp), "applied (PR_SET_THP_DISABLE)");
+    else snprintf(thp, sizeof(thp), "failed: %s", strerror(errno));
+
+    // Prefer CPUs the kernel keeps quiet: isolcpus=, then nohz_full=
+    int plan[MAX_CPUS], quiet[MAX_CPUS];
+    const char *source = "isolated";
+    int nquiet = read_cpu_list_file("/sys/devices/system/cpu/isolated", quiet, MAX_CPUS);
+    if (nquiet == 0) {
+        source = "nohz_full";
+        nquiet = read_cpu_list_file("/sys/devices/system/cpu/nohz_full", quiet, MAX_CPUS);
+    }
+    int distinct = num_threads;
+    if (nquiet > 0) {
+        for (int i = 0; i < num_threads; i++) plan[i] = quiet[i % nquiet];
+        distinct = MIN(nquiet, num_threads);
+    } else {
+        binding_plan(BIND_CORE, NULL, num_threads, plan);
+        distinct = MIN(topo.num_cpus, num_threads);
+    }
+    pin_team(plan, num_threads);
+    int placed[MAX_CPUS], moved[MAX_CPUS] = {0}, pinned = 0;
+    for (int i = 0; i < num_threads; i++) placed[i] = -1;
+    sample_thread_cpus(num_threads, placed, moved);
+    for (int i = 0; i < num_threads; i++) pinned += placed[i] == plan[i];
+    if (nquiet > 0) {
+        snprintf(cpus_status, sizeof(cpus_status), "%d/%d threads on %s CPUs", pinned, num_threads, source);
+    } else {
+        snprintf(cpus_status, sizeof(cpus_status), "none isolated, one thread per core");
+    }
+
+    // Team first-touches the arrays, then everything mapped so far is locked.
+    // MCL_FUTURE would prefault on the allocating thread and defeat first touch.
+    alloc_arrays(num_threads, array_size);
+    if (mlockall(MCL_CURRENT) == 0) snprintf(mlock_status, sizeof(mlock_status), "applied (MCL_CURRENT)");
+    else snprintf(mlock_status, sizeof(mlock_status), "failed: %s", strerror(errno));
+
+    // SCHED_FIFO only without oversubscription: a spinning FIFO thread would
+    // starve a sibling sharing its CPU
+    int rt = 0;
+    if (distinct < num_threads) {
+        snprintf(fifo, sizeof(fifo), "skipped: %d threads share %d CPUs", num_threads, distinct);
+    } else {
+        struct sched_param sp = { .sched_priority = sched_get_priority_min(SCHED_FIFO) };
+        #pragma omp parallel reduction(+:rt)
+        rt += pthread_setschedparam(pthread_self(), SCHED_FIFO, &sp) == 0;
+        if (rt == num_threads) snprintf(fifo, sizeof(fifo), "applied to all threads (priority %d)", sp.sched_priority);
+        else if (rt > 0) snprintf(fifo, sizeof(fifo), "applied to %d/%d threads", rt, num_threads);
+        else snprintf(fifo, sizeof(fifo), "not permitted (needs CAP_SYS_NICE)");
+    }
+
+    lownoise_measure(array_size, reads, writes, LOWNOISE_WARMUP, bw_quiet);
+
+    // Undo everything that outlives this mode
+    if (rt > 0) {
+        struct sched_param sp = { .sched_priority = 0 };
+        #pragma omp parallel
+        pthread_setschedparam(pthread_self(), SCHED_OTHER, &sp);
+    }
+    munlockall();
+    prctl(PR_SET_THP_DISABLE, 0, 0, 0, 0);
+    free_arrays();
+#if defined(M_TRIM_THRESHOLD)
+    // glibc cannot report the old value; its default is a fixed 128 KB
+    mallopt(M_TRIM_THRESHOLD, LOWNOISE_TRIM_DEFAULT);
+#endif
+
+    printf("════════════════════════════════════════════════════════════\n");
+    printf("  UltraMem - Low-Noise Run\n");
+    printf("════════════════════════════════════════════════════════════\n");
+    printf("  Kernel pattern:    %d:%d\n", reads, writes);
+    printf("  Threads:           %d\n", num_threads);
+    printf("  Memory per array:  %.1f MB\n", (double)(array_size * sizeof(double)) / (1024.0 * 1024.0));
+    printf("  SCHED_FIFO:        %s\n", fifo);
+    printf("  mlockall:          %s\n", mlock_status);
+    printf("  Quiet CPUs:        %s\n", cpus_status);
+    printf("  THP disabled:      %s\n", thp);
+    printf("  malloc trimming:   %s\n", trim);
+    printf("  Pre-warm:          %d extra passes\n", LOWNOISE_WARMUP);
+    printf("════════════════════════════════════════════════════════════\n\n");
+
+    printf("────────────────────────────────────────────────────────────\n");
+    printf("Run          Best MB/s   Mean MB/s     Stddev       CV     Spread\n");
+    printf("────────────────────────────────────────────────────────────\n");
+    print_lownoise_row("Default", bw_default);
+    print_lownoise_row("Low-noise", bw_quiet);
+    printf("────────────────────────────────────────────────────────────\n");
+    stats_t d = compute_stats(bw_default, opts.iters - 1), q = compute_stats(bw_quiet, opts.iters - 1);
+    if (q.cv > 0.0) {
+        printf("  CV ratio:          %.2fx (default / low-noise, above 1 = quieter)\n", d.cv / q.cv);
+    }
+    printf("\n");
+    free(bw_default);
+    free(bw_quiet);
+    return 0;
+}
+#else
+static int run_lownoise(int num_threads, size_t array_size, int reads, int writes) {
+    (void)num_threads; (void)array_size; (void)reads; (void)writes;
+    fprintf(stderr, "Error: --mode=lownoise requires Linux\n");
+    return 1;
+}
+#endif
+
+// ============================================================================
+// Hybrid CPUs: per-class bandwidth and bandwidth-weighted partitioning
+// ============================================================================
+
+#if defined(__linux__)
+static int run_hybrid(int num_threads, size_t array_size, int reads, int writes) {
+    detect_topology();
+
+    int order[MAX_CPUS];
+    int total = topology_core_order(order);
+    double per_thread_gbs[MAX_CORE_CLASSES] = {0};
+    int team_class[MAX_CPUS];
+
+    printf("════════════════════════════════════════════════════════════\n");
+    printf("  UltraMem - Hybrid Core Bandwidth\n");
+    printf("════════════════════════════════════════════════════════════\n");
+    printf("  Core classes from: %s\n", topo.class_source);
+    printf("  Kernel pattern:    %d:%d\n", reads, writes);
+    printf("  Memory per array:  %.1f MB\n", (double)(array_size * sizeof(double)) / (1024.0 * 1024.0));
+    printf("════════════════════════════════════════════════════════════\n\n");
+
+    printf("────────────────────────────────────────────────────────────\n");
+    printf("Class       CPUs  Threads       GB/s  GB/s/thread  Capacity\n");
+    printf("────────────────────────────────────────────────────────────\n");
+    for (int k = 0; k < topo.num_classes; k++) {
+        // This class only, one thread per core first
+        int plan[MAX_CPUS], ncls = 0, capacity = 0;
+        for (int i = 0; i < total; i++) {
+            const cpu_topo_t *t = topology_find(order[i]);
+            if (t->core_class != k) continue;
+            plan[ncls++] = t->cpu;
+            capacity = t->capacity;
+        }
+        int nt = MIN(num_threads, ncls);
+        if (nt == 0) continue;
+
+        omp_set_num_threads(nt);
+        pin_team(plan, nt);
+        alloc_arrays(nt, array_size);
+        double gbs = kernel_best_bw(array_size, reads, writes) / 1000.0;
+        free_arrays();
+        per_thread_gbs[k] = gbs / nt;
+
+        printf("%-10s  %4d  %7d  %9.2f  %11.2f  %8d\n", topo.class_names[k], ncls, nt,
+               gbs, per_thread_gbs[k], capacity);
+    }
+    printf("────────────────────────────────────────────────────────────\n\n");
+
+    // Mixed team in core order; weights are each class's measured
+    // single-class bandwidth per thread, falling back to cpu_capacity for a
+    // class that could not be measured
+    int nt = MIN(num_threads, total);
+    double weights[MAX_CPUS];
+    int class_count[MAX_CORE_CLASSES] = {0};
+    for (int t = 0; t < nt; t++) {
+        const cpu_topo_t *ct = topology_find(order[t]);
+        team_class[t] = ct->core_class;
+        class_count[ct->core_class]++;
+        weights[t] = per_thread_gbs[ct->core_class] > 0 ? per_thread_gbs[ct->core_class]
+                                                         : (ct->capacity > 0 ? ct->capacity : 1.0);
+    }
+
+    printf("Mixed team of %d threads:", nt);
+    int classes_in_team = 0;
+    for (int k = 0; k < topo.num_classes; k++) {
+        if (class_count[k] == 0) continue;
+        printf(" %d %s", class_count[k], topo.class_names[k]);
+        classes_in_team++;
+    }
+    printf("\n");
+    if (classes_in_team < 2) {
+        printf("Note: team has a single core class, weighting cannot help\n");
+    }
+
+    omp_set_num_threads(nt);
+    pin_team(order, nt);
+    alloc_arrays(nt, array_size);
+    // Same slicing kernel for both so only the split differs
+    double equal[MAX_CPUS];
+    for (int t = 0; t < nt; t++) equal[t] = 1.0;
+    double equal_gbs = kernel_best_bw_weighted(array_size, reads, writes, equal) / 1000.0;
+    double weighted_gbs = kernel_best_bw_weighted(array_size, reads, writes, weights) / 1000.0;
+    free_arrays();
+
+    printf("────────────────────────────────────────────────────────────\n");
+    printf("Partition              GB/s\n");
+    printf("────────────────────────────────────────────────────────────\n");
+    printf("%-18s  %8.2f\n", "equal (static)", equal_gbs);
+    printf("%-18s  %8.2f   %+.1f%%\n", "bandwidth-weighted", weighted_gbs,
+           100.0 * (weighted_gbs / equal_gbs - 1.0));
+    printf("────────────────────────────────────────────────────────────\n");
+    printf("Weights:");
+    for (int k = 0; k < topo.num_classes; k++) {
+        for (int t = 0; t < nt; t++) {
+            if (team_class[t] == k) {
+                printf(" %s %.2f", topo.class_names[k], weights[t] / weights[0]);
+                break;
+            }
+        }
+    }
+    printf(" (relative to thread 0)\n\n");
+    return 0;
+}
+#else
+static int run_hybrid(int num_threads, size_t array_size, int reads, int writes) {
+    (void)num_threads; (void)array_size; (void)reads; (void)writes;
+    fprintf(stderr, "Error: --mode=hybrid requires Linux\n");
+    return 1;
+}
+#endif
+
+// ============================================================================
+// Loop schedule comparison, quiet and with an injected CPU hog
+// ============================================================================
+
+#if defined(__linux__)
+static volatile int noise_stop;
+
+// Busy loop sharing a CPU with one team thread, like an IRQ-heavy core
+static void *noise_spin(void *arg) {
+    pin_to_cpu((int)(intptr_t)arg);
+    while (!noise_stop) { }
+    return NULL;
+}
+
+// Mean bandwidth (MB/s) and load imbalance (%) over iterations 1..iters-1.
+// Imbalance is 1 - mean/max of the per-thread finish times: the share of the
+// team's time spent waiting at the closing barrier.
+static void schedule_measure(size_t n, int reads, int writes, int nt,
+                             double *bw, double *imbalance) {
+    double finish[MAX_CPUS], total_time = 0.0, total_imb = 0.0, sink = 0.0;
+    for (int k = 0; k < opts.iters; k++) {
+        double t = get_time_sec();
+        sink += kernel_run(n, reads, writes, finish);
+        t = get_time_sec() - t;
+        if (k == 0) continue;
+        double sum = 0.0, mx = 0.0;
+        for (int i = 0; i < nt; i++) {
+            sum += finish[i];
+            mx = MAX(mx, finish[i]);
+        }
+        total_time += t;
+        total_imb += mx > 0.0 ? 1.0 - sum / nt / mx : 0.0;
+    }
+    *bw = 1.0E-06 * pattern_bytes_per_elem(reads, writes) * n / (total_time / (opts.iters - 1));
+    *imbalance = 100.0 * total_imb / (opts.iters - 1);
+    if (sink < -1e30) printf("%f", sink);
+}
+
+static int run_schedule(int num_threads, size_t array_size, int reads, int writes) {
+    static const struct { sched_kind_t kind; size_t chunk; const char *label; } configs[] = {
+        { SCHED_STATIC,  0,         "static"        },
+        { SCHED_DYNAMIC, 64,        "dynamic:line"  },
+        { SCHED_DYNAMIC, 4096,      "dynamic:page"  },
+        { SCHED_GUIDED,  4096,      "guided:page"   },
+        { SCHED_STEAL,   64 * 1024, "steal:64K"     },
+    };
+    int nconf = (int)(sizeof(configs) / sizeof(configs[0]));
+
+    // Interference needs a known victim CPU, so always pin the team
+    bind_policy_t policy = opts.bind == BIND_NONE ? BIND_CORE : opts.bind;
+    int plan[MAX_CPUS];
+    if (binding_plan(policy, opts.bind_list, num_threads, plan) < 0) return 1;
+    omp_set_num_threads(num_threads);
+    bind_team(policy, opts.bind_list, num_threads);
+    alloc_arrays(num_threads, array_size);
+
+    printf("════════════════════════════════════════════════════════════\n");
+    printf("  UltraMem - Loop Schedule Comparison\n");
+    printf("════════════════════════════════════════════════════════════\n");
+    printf("  Kernel pattern:    %d:%d\n", reads, writes);
+    printf("  Threads:           %d\n", num_threads);
+    printf("  Binding:           %s\n", bind_policy_name(policy));
+    printf("  Memory per array:  %.1f MB\n", (double)(array_size * sizeof(double)) / (1024.0 * 1024.0));
+    printf("  Interference:      busy thread pinned to CPU %d (thread 0)\n", plan[0]);
+    printf("  Iterations:        %d per row (mean reported)\n", opts.iters);
+    printf("════════════════════════════════════════════════════════════\n\n");
+
+    sched_kind_t saved_kind = opts.schedule;
+    size_t saved_chunk = opts.chunk_bytes;
+    double bw[2][8], imb[2][8];
+    for (int noisy = 0; noisy < 2; noisy++) {
+        pthread_t hog;
+        if (noisy) {
+            noise_stop = 0;
+            if (pthread_create(&hog, NULL, noise_spin, (void *)(intptr_t)plan[0]) != 0) {
+                fprintf(stderr, "Error: cannot start interference thread\n");
+                free_arrays();
+                return 1;
+            }
+        }
+        for (int i = 0; i < nconf; i++) {
+            opts.schedule = configs[i].kind;
+            opts.chunk_bytes = configs[i].chunk ? configs[i].chunk : saved_chunk;
+            schedule_measure(array_size, reads, writes, num_threads, &bw[noisy][i], &imb[noisy][i]);
+        }
+        if (noisy) {
+            noise_stop = 1;
+            pthread_join(hog, NULL);
+        }
+    }
+    opts.schedule = saved_kind;
+    opts.chunk_bytes = saved_chunk;
+
+    printf("────────────────────────────────────────────────────────────\n");
+    printf("%-14s  %10s  %8s  %10s  %8s\n", "", "Quiet", "", "Interfered", "");
+    printf("%-14s  %10s  %8s  %10s  %8s\n", "Schedule", "GB/s", "Imbal%", "GB/s", "Imbal%");
+    printf("────────────────────────────────────────────────────────────\n");
+    for (int i = 0; i < nconf; i++) {
+        printf("%-14s  %10.2f  %8.1f  %10.2f  %8.1f\n", configs[i].label,
+               bw[0][i] / 1000.0, imb[0][i], bw[1][i] / 1000.0, imb[1][i]);
+    }
+    printf("────────────────────────────────────────────────────────────\n");
+    printf("Imbal%% = time threads wait at the closing barrier (1 - mean/max finish)\n\n");
+
+    free_arrays();
+    return 0;
+}
+#else
+static int run_schedule(int num_threads, size_t array_size, int reads, int writes) {
+    (void)num_threads; (void)array_size; (void)reads; (void)writes;
+    fprintf(stderr, "Error: --mode=schedule requires Linux\n");
+    return 1;
+}
+#endif
+
+// ============================================================================
+// Fork/join microbenchmark per thread count and placement
+// ============================================================================
+
+#if defined(__linux__)
+static int run_forkjoin(int num_threads) {
+    // Same two placements as --mode=smt unless --bind picks one
+    bind_policy_t policies[2] = { BIND_CORE, BIND_COMPACT };
+    int nplace = 2;
+    if (opts.bind != BIND_NONE) {
+        policies[0] = opts.bind;
+        nplace = 1;
+    }
+    static const char *const names[FJ_KINDS] = { "parallel", "barrier", "for", "spin" };
+
+    printf("════════════════════════════════════════════════════════════\n");
+    printf("  UltraMem - Fork/Join Overhead\n");
+    printf("════════════════════════════════════════════════════════════\n");
+    printf("  Threads:           1 .. %d (%s)\n", num_threads, opts.sweep_linear ? "linear" : "powers of two");
+    printf("  Operations:        %d per trial, best of %d\n", FJ_REPS, FJ_TRIALS);
+    printf("════════════════════════════════════════════════════════════\n\n");
+
+    for (int p = 0; p < nplace; p++) {
+        printf("Binding: %s\n", bind_policy_name(policies[p]));
+        printf("────────────────────────────────────────────────────────────\n");
+        printf("Threads");
+        for (int k = 0; k < FJ_KINDS; k++) printf("  %10s", names[k]);
+        printf("   (us/op)\n");
+        printf("────────────────────────────────────────────────────────────\n");
+        for (int t = 1; t <= num_threads;
+             t = opts.sweep_linear ? t + 1 : next_pow2_count(t, num_threads)) {
+            omp_set_num_threads(t);
+            if (bind_team(policies[p], opts.bind_list, t) != 0) return 1;
+            printf("%7d", t);
+            for (int k = 0; k < FJ_KINDS; k++) {
+                printf("  %10.3f", fork_join_cost((fj_kind_t)k, FJ_REPS) * 1e6);
+            }
+            printf("\n");
+            fflush(stdout);
+        }
+        printf("────────────────────────────────────────────────────────────\n\n");
+    }
+    printf("parallel = empty omp parallel, barrier = omp barrier, for = empty omp for,\n");
+    printf("spin = sense-reversing spin barrier (as used by --backend=pthread)\n\n");
+    return 0;
+}
+#else
+static int run_forkjoin(int num_threads) {
+    (void)num_threads;
+    fprintf(stderr, "Error: --mode=forkjoin requires Linux\n");
+    return 1;
+}
+#endif
+
+// ============================================================================
+// Storage -> memory streaming via io_uring + O_DIRECT (Linux only)
+// ============================================================================
+
+#if defined(__linux__)
+// Minimal raw-syscall io_uring (no liburing dependency)
+typedef struct {
+    int fd;
+    unsigned entries;
+    unsigned *sq_head, *sq_tail, *sq_mask, *sq_array;
+    unsigned *cq_head, *cq_tail, *cq_mask;
+    struct io_uring_sqe *sqes;
+    struct io_uring_cqe *cqes;
+    void *sq_ring, *cq_ring;
+    size_t sq_ring_sz, cq_ring_sz, sqes_sz;
+} uring_t;
+
+static void uring_free(uring_t *r) {
+    if (r->sqes && r->sqes != MAP_FAILED) munmap(r->sqes, r->sqes_sz);
+    if (r->cq_ring && r->cq_ring != MAP_FAILED && r->cq_ring != r->sq_ring)
+        munmap(r->cq_ring, r->cq_ring_sz);
+    if (r->sq_ring && r->sq_ring != MAP_FAILED) munmap(r->sq_ring, r->sq_ring_sz);
+    if (r->fd >= 0) close(r->fd);
+    r->fd = -1;
+}
+
+static int uring_init(uring_t *r, unsigned entries) {
+    struct io_uring_params p;
+    memset(&p, 0, sizeof(p));
+    memset(r, 0, sizeof(*r));
+
+    r->fd = (int)syscall(__NR_io_uring_setup, entries, &p);
+    if (r->fd < 0) return -1;
+    r->entries = p.sq_entries;
+
+    int single_mmap = (p.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    r->sq_ring_sz = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    r->cq_ring_sz = p.cq_off.cqes + p.cq_entries * sizeof(struct io_uring_cqe);
+    if (single_mmap) {
+        r->sq_ring_sz = r->cq_ring_sz = MAX(r->sq_ring_sz, r->cq_ring_sz);
+    }
+
+    r->sq_ring = mmap(NULL, r->sq_ring_sz, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, r->fd, IORING_OFF_SQ_RING);
+    if (r->sq_ring == MAP_FAILED) { uring_free(r); return -1; }
+
+    if (single_mmap) {
+        r->cq_ring = r->sq_ring;
+    } else {
+        r->cq_ring = mmap(NULL, r->cq_ring_sz, PROT_READ | PROT_WRITE,
+                          MAP_SHARED | MAP_POPULATE, r->fd, IORING_OFF_CQ_RING);
+        if (r->cq_ring == MAP_FAILED) { uring_free(r); return -1; }
+    }
+
+    r->sqes_sz = p.sq_entries * sizeof(struct io_uring_sqe);
+    r->sqes = mmap(NULL, r->sqes_sz, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_POPULATE, r->fd, IORING_OFF_SQES);
+    if (r->sqes == MAP_FAILED) { uring_free(r); return -1; }
+
+    char *sq = (char *)r->sq_ring;
+    char *cq = (char *)r->cq_ring;
+    r->sq_head  = (unsigned *)(sq + p.sq_off.head);
+    r->sq_tail  = (unsigned *)(sq + p.sq_off.tail);
+    r->sq_mask  = (unsigned *)(sq + p.sq_off.ring_mask);
+    r->sq_array = (unsigned *)(sq + p.sq_off.array);
+    r->cq_head  = (unsigned *)(cq + p.cq_off.head);
+    r->cq_tail  = (unsigned *)(cq + p.cq_off.tail);
+    r->cq_mask  = (unsigned *)(cq + p.cq_off.ring_mask);
+    r->cqes     = (struct io_uring_cqe *)(cq + p.cq_off.cqes);
+    return 0;
+}
+
+// Queue one read; buf_index < 0 means a plain (unregistered) buffer
+static int uring_queue_read(uring_t *r, int fd, void *buf, unsigned len,
+                            uint64_t off, int buf_index, uint64_t user_data) {
+    unsigned tail = *r->sq_tail;
+    unsigned head = __atomic_load_n(r->sq_head, __ATOMIC_ACQUIRE);
+    if (tail - head >= r->entries) return -1;
+
+    unsigned idx = tail & *r->sq_mask;
+    struct io_uring_sqe *sqe = &r->sqes[idx];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = buf_index >= 0 ? IORING_OP_READ_FIXED : IORING_OP_READ;
+    sqe->fd = fd;
+    sqe->addr = (uint64_t)(uintptr_t)buf;
+    sqe->len = len;
+    sqe->off = off;
+    sqe->buf_index = buf_index >= 0 ? (uint16_t)buf_index : 0;
+    sqe->user_data = user_data;
+
+    r->sq_array[idx] = idx;
+    __atomic_store_n(r->sq_tail, tail + 1, __ATOMIC_RELEASE);
+    return 0;
+}
+
+static int uring_enter(uring_t *r, unsigned to_submit, unsigned min_complete) {
+    for (;;) {
+        long ret = syscall(__NR_io_uring_enter, r->fd, to_submit, min_complete,
+                           min_complete ? IORING_ENTER_GETEVENTS : 0, NULL, 0);
+        if (ret >= 0) return (int)ret;
+        if (errno != EINTR) return -1;
+    }
+}
+
+static int uring_reap(uring_t *r, struct io_uring_cqe *out) {
+    unsigned head = *r->cq_head;
+    if (head == __atomic_load_n(r->cq_tail, __ATOMIC_ACQUIRE)) return 0;
+    *out = r->cqes[head & *r->cq_mask];
+    __atomic_store_n(r->cq_head, head + 1, __ATOMIC_RELEASE);
+    return 1;
+}
+
+// Registered buffers are split into 1 GB iovecs; block_size must divide 1 GB
+#define URING_FIXED_CHUNK (1UL << 30)
+
+// Run the 1:0 kernel over buf[lo, hi) by pointing the global array at it
+static double uring_kernel_range(char *buf, size_t lo, size_t hi) {
+    double *saved = a;
+    a = (double *)(buf + lo);
+    double sum = kernel_generic((hi - lo) / sizeof(double), 1, 0);
+    a = saved;
+    return sum;
+}
+
+// Stream nbytes of fd into buf with up to queue_depth reads in flight.
+// With pipeline set, the 1:0 kernel consumes each contiguous run of completed
+// blocks (at least queue_depth blocks) while the following reads are still in
+// flight. Returns elapsed seconds, or -1 on I/O error.
+static double uring_stream(uring_t *r, int fd, char *buf, size_t nbytes,
+                           int fixed, int pipeline, double *dummy_sum) {
+    size_t bs = opts.block_size;
+    size_t nblocks = (nbytes + bs - 1) / bs;
+    size_t segment = (size_t)opts.queue_depth;
+    unsigned char *done = (unsigned char *)calloc(nblocks, 1);
+    if (!done) return -1;
+
+    size_t next_submit = 0, completed = 0, ready_end = 0, next_kernel = 0;
+    unsigned inflight = 0, to_submit = 0;
+    double t0 = get_time_sec();
+
+    while (completed < nblocks) {
+        while (inflight < (unsigned)opts.queue_depth && next_submit < nblocks) {
+            size_t off = next_submit * bs;
+            unsigned len = (unsigned)MIN(bs, nbytes - off);
+            int buf_index = fixed ? (int)(off / URING_FIXED_CHUNK) : -1;
+            if (uring_queue_read(r, fd, buf + off, len, off, buf_index, next_submit) != 0) break;
+            next_submit++;
+            inflight++;
+            to_submit++;
+        }
+
+        if (uring_enter(r, to_submit, 1) < 0) {
+            fprintf(stderr, "Error: io_uring_enter: %s\n", strerror(errno));
+            free(done);
+            return -1;
+        }
+        to_submit = 0;
+
+        struct io_uring_cqe cqe;
+        while (uring_reap(r, &cqe)) {
+            size_t blk = (size_t)cqe.user_data;
+            size_t want = MIN(bs, nbytes - blk * bs);
+            if (cqe.res < 0 || (size_t)cqe.res != want) {
+                fprintf(stderr, "Error: read at offset %zu: %s\n", blk * bs,
+                        cqe.res < 0 ? strerror(-cqe.res) : "short read");
+                free(done);
+                return -1;
+            }
+            done[blk] = 1;
+            inflight--;
+            completed++;
+        }
+
+        if (pipeline) {
+            while (ready_end < nblocks && done[ready_end]) ready_end++;
+            if (ready_end - next_kernel >= segment ||
+                (ready_end == nblocks && ready_end > next_kernel)) {
+                *dummy_sum += uring_kernel_range(buf, next_kernel * bs,
+                                                 MIN(ready_end * bs, nbytes));
+                next_kernel = ready_end;
+            }
+        }
+    }
+
+    if (pipeline && next_kernel < nblocks) {
+        *dummy_sum += uring_kernel_range(buf, next_kernel * bs, nbytes);
+    }
+
+    free(done);
+    return get_time_sec() - t0;
+}
+
+static int run_iouring(int num_threads, size_t array_size) {
+    omp_set_num_threads(num_threads);
+
+    if (!opts.file) {
+        fprintf(stderr, "Error: --mode=iouring requires --file=PATH\n");
+        return 1;
+    }
+
+    int direct = 1;
+    int fd = open(opts.file, O_RDONLY | O_DIRECT);
+    if (fd < 0 && errno == EINVAL) {
+        // tmpfs and some overlay filesystems reject O_DIRECT
+        fprintf(stderr, "Warning: O_DIRECT not supported on '%s', using page cache\n", opts.file);
+        direct = 0;
+        fd = open(opts.file, O_RDONLY);
+    }
+    if (fd < 0) {
+        fprintf(stderr, "Error: cannot open '%s': %s\n", opts.file, strerror(errno));
+        return 1;
+    }
+
+    struct stat st;
+    uint64_t file_size = 0;
+    if (fstat(fd, &st) == 0) {
+        file_size = (uint64_t)st.st_size;
+        if (S_ISBLK(st.st_mode) && ioctl(fd, BLKGETSIZE64, &file_size) != 0) file_size = 0;
+    }
+
+    // O_DIRECT needs page-aligned offsets and lengths
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t nbytes = (size_t)MIN(file_size, (uint64_t)array_size * sizeof(double));
+    nbytes -= nbytes % page;
+    if (nbytes < opts.block_size) {
+        fprintf(stderr, "Error: '%s' is smaller than one block (%zu bytes)\n",
+                opts.file, opts.block_size);
+        close(fd);
+        return 1;
+    }
+
+    char *buf = (char *)alloc_aligned(page, nbytes);
+    if (!buf) {
+        fprintf(stderr, "Memory allocation failed\n");
+        close(fd);
+        return 1;
+    }
+
+    // First touch in parallel so page faults stay out of the timed reads
+    #pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < nbytes; i += page) buf[i] = 0;
+
+    uring_t ring;
+    if (uring_init(&ring, (unsigned)opts.queue_depth) != 0) {
+        fprintf(stderr, "Error: io_uring_setup: %s\n", strerror(errno));
+        aligned_free(buf);
+        close(fd);
+        return 1;
+    }
+
+    int fixed = 0;
+    if (opts.fixed_buffers) {
+        size_t nvec = (nbytes + URING_FIXED_CHUNK - 1) / URING_FIXED_CHUNK;
+        struct iovec *iov = (struct iovec *)calloc(nvec, sizeof(*iov));
+        for (size_t i = 0; iov && i < nvec; i++) {
+            iov[i].iov_base = buf + i * URING_FIXED_CHUNK;
+            iov[i].iov_len = MIN(URING_FIXED_CHUNK, nbytes - i * URING_FIXED_CHUNK);
+        }
+        if (iov && syscall(__NR_io_uring_register, ring.fd, IORING_REGISTER_BUFFERS,
+                           iov, (unsigned)nvec) == 0) {
+            fixed = 1;
+        } else {
+            fprintf(stderr, "Warning: buffer registration failed (%s), using plain reads\n",
+                    strerror(errno));
+        }
+        free(iov);
+    }
+
+    // b and c are not touched by the 1:0 kernel
+    a = b = c = (double *)buf;
+
+    double nbytes_mb = (double)nbytes / (1024.0 * 1024.0);
+    printf("════════════════════════════════════════════════════════════\n");
+    printf("  UltraMem - Storage to Memory Bandwidth (io_uring)\n");
+    printf("════════════════════════════════════════════════════════════\n");
+    printf("  File:              %s\n", opts.file);
+    printf("  Bytes streamed:    %.1f MB\n", nbytes_mb);
+    printf("  I/O mode:          %s\n", direct ? "O_DIRECT" : "buffered (page cache)");
+    printf("  Queue depth:       %u\n", ring.entries);
+    printf("  Block size:        %zu KB\n", opts.block_size / 1024);
+    printf("  Registered bufs:   %s\n", fixed ? "yes" : "no");
+    printf("  Kernel threads:    %d (1:0 pattern)\n", num_threads);
+    printf("════════════════════════════════════════════════════════════\n\n");
+
+    double dummy_sum = 0.0;
+    int ret = 0;
+
+    double storage_t = uring_stream(&ring, fd, buf, nbytes, fixed, 0, &dummy_sum);
+    if (storage_t < 0) {
+        ret = 1;
+        goto out;
+    }
+    double storage_gbs = nbytes / storage_t / 1e9;
+    double memory_gbs = kernel_best_bw(nbytes / sizeof(double), 1, 0) / 1000.0;
+
+    printf("────────────────────────────────────────────────────────────\n");
+    printf("Stage                 GB/s        Time (s)\n");
+    printf("────────────────────────────────────────────────────────────\n");
+    printf("%-18s  %8.2f      %10.6f\n", "storage (read)", storage_gbs, storage_t);
+    printf("%-18s  %8.2f      %10.6f\n", "memory (1:0)", memory_gbs,
+           nbytes / (memory_gbs * 1e9));
+
+    double pipe_gbs = 0.0;
+    if (opts.pipeline) {
+        double pipe_t = uring_stream(&ring, fd, buf, nbytes, fixed, 1, &dummy_sum);
+        if (pipe_t < 0) {
+            ret = 1;
+            goto out;
+        }
+        pipe_gbs = nbytes / pipe_t / 1e9;
+        printf("%-18s  %8.2f      %10.6f\n", "pipelined", pipe_gbs, pipe_t);
+    }
+    printf("────────────────────────────────────────────────────────────\n\n");
+
+    printf("════════════════════════════════════════════════════════════\n");
+    printf("  INGEST BOUND: %s (storage %.2f GB/s vs memory %.2f GB/s)\n",
+           storage_gbs < memory_gbs ? "storage" : "memory", storage_gbs, memory_gbs);
+    if (opts.pipeline) {
+        double serial_gbs = 1.0 / (1.0 / storage_gbs + 1.0 / memory_gbs);
+        printf("  Pipelined: %.2f GB/s (serial estimate %.2f GB/s)\n", pipe_gbs, serial_gbs);
+    }
+    printf("════════════════════════════════════════════════════════════\n\n");
+
+    if (dummy_sum < -1e30) printf("%f", dummy_sum);
+
+out:
+    uring_free(&ring);
+    close(fd);
+    aligned_free(buf);
+    a = b = c = NULL;
+    return ret;
+}
+#else
+static int run_iouring(int num_threads, size_t array_size) {
+    (void)num_threads; (void)array_size;
+    fprintf(stderr, "Error: --mode=iouring requires Linux\n");
+    return 1;
+}
+#endif
+
+// ============================================================================
+// Inter-process pipe / splice / socket bandwidth (Linux only)
+// ============================================================================
+
+#if defined(__linux__)
+typedef enum {
+    IPC_PIPE_RW = 0,        // write() -> pipe -> read()
+    IPC_VMSPLICE_READ,      // vmsplice() -> pipe -> read()
+    IPC_VMSPLICE_SPLICE,    // vmsplice() -> pipe -> splice() to /dev/null
+    IPC_UNIX,               // send() -> AF_UNIX stream -> recv()
+    IPC_UNIX_ZEROCOPY,      // send(MSG_ZEROCOPY) -> AF_UNIX stream -> recv()
+    IPC_NUM_METHODS
+} ipc_method_t;
+
+static const char *ipc_method_names[IPC_NUM_METHODS] = {
+    "pipe write/read", "vmsplice+read", "vmsplice+splice",
+    "unix send/recv", "unix zerocopy",
+};
+
+// Counters the producer child reports back through shared memory
+typedef struct {
+    long syscalls;
+    int error;
+} ipc_shared_t;
+
+#ifdef SO_ZEROCOPY
+// Drain MSG_ZEROCOPY completion notifications; returns syscalls made
+static long ipc_drain_errqueue(int fd) {
+    char control[128];
+    long calls = 0;
+    for (;;) {
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        calls++;
+        if (recvmsg(fd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) < 0) break;
+    }
+    return calls;
+}
+#endif
+
+static void ipc_producer(ipc_method_t method, int fd, size_t msg, size_t total,
+                         ipc_shared_t *shared) {
+    char *buf = (char *)alloc_aligned((size_t)sysconf(_SC_PAGESIZE), msg);
+    if (!buf) { shared->error = ENOMEM; return; }
+    memset(buf, 1, msg);
+
+    size_t sent = 0, off = 0;
+    long calls = 0;
+    while (sent < total) {
+        size_t len = MIN(msg - off, total - sent);
+        ssize_t n;
+        if (method == IPC_PIPE_RW) {
+            n = write(fd, buf + off, len);
+        } else if (method == IPC_VMSPLICE_READ || method == IPC_VMSPLICE_SPLICE) {
+            struct iovec iov = { buf + off, len };
+            n = vmsplice(fd, &iov, 1, 0);
+#ifdef SO_ZEROCOPY
+        } else if (method == IPC_UNIX_ZEROCOPY) {
+            n = send(fd, buf + off, len, MSG_ZEROCOPY);
+            if (n < 0 && errno == ENOBUFS) {
+                calls += 1 + ipc_drain_errqueue(fd);
+                continue;
+            }
+#endif
+        } else {
+            n = send(fd, buf + off, len, 0);
+        }
+        calls++;
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            shared->error = errno;
+            break;
+        }
+        sent += (size_t)n;
+        off = (off + (size_t)n) % msg;
+    }
+#ifdef SO_ZEROCOPY
+    if (method == IPC_UNIX_ZEROCOPY) calls += ipc_drain_errqueue(fd);
+#endif
+
+    shared->syscalls = calls;
+    aligned_free(buf);
+}
+
+// Returns bytes received, or -1 on error; *calls gets the syscall count
+static long ipc_consumer(ipc_method_t method, int fd, int devnull, size_t msg,
+                         size_t total, long *calls) {
+    char *buf = (char *)alloc_aligned((size_t)sysconf(_SC_PAGESIZE), msg);
+    if (!buf) return -1;
+    memset(buf, 0, msg);
+
+    size_t got = 0;
+    *calls = 0;
+    while (got < total) {
+        size_t len = MIN(msg, total - got);
+        ssize_t n;
+        if (method == IPC_VMSPLICE_SPLICE) {
+            n = splice(fd, NULL, devnull, NULL, len, SPLICE_F_MOVE);
+        } else if (method == IPC_UNIX || method == IPC_UNIX_ZEROCOPY) {
+            n = recv(fd, buf, len, 0);
+        } else {
+            n = read(fd, buf, len);
+        }
+        (*calls)++;
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        got += (size_t)n;
+    }
+
+    aligned_free(buf);
+    return (long)got;
+}
+
+// MSG_ZEROCOPY is silently a plain copy unless SO_ZEROCOPY is set on the
+// sending socket itself; AF_UNIX rejects it on current kernels
+static int ipc_enable_zerocopy(int fd) {
+#ifdef SO_ZEROCOPY
+    int one = 1;
+    return setsockopt(fd, SOL_SOCKET, SO_ZEROCOPY, &one, sizeof(one));
+#else
+    (void)fd;
+    errno = EOPNOTSUPP;
+    return -1;
+#endif
+}
+
+// Move total bytes from a pinned child (producer) to the pinned parent
+// (consumer). Returns elapsed seconds, -2 if zerocopy cannot be enabled on
+// the socket, or -1 on other failures; *syscalls counts both sides.
+static double ipc_run_one(ipc_method_t method, size_t msg, size_t total,
+                          int cpu_prod, int cpu_cons, ipc_shared_t *shared,
+                          long *syscalls) {
+    int fds[2], ctl[2];
+    int is_socket = (method == IPC_UNIX || method == IPC_UNIX_ZEROCOPY);
+
+    if (is_socket) {
+        if (socketpair(AF_UNIX, SOCK_STREAM, 0, fds) != 0) return -1;
+        int sz = (int)MIN(msg * 4, 64UL << 20);
+        setsockopt(fds[0], SOL_SOCKET, SO_RCVBUF, &sz, sizeof(sz));
+        setsockopt(fds[1], SOL_SOCKET, SO_SNDBUF, &sz, sizeof(sz));
+        if (method == IPC_UNIX_ZEROCOPY && ipc_enable_zerocopy(fds[1]) != 0) {
+            int err = errno;
+            close(fds[0]); close(fds[1]);
+            errno = err;
+            return -2;
+        }
+    } else {
+        if (pipe(fds) != 0) return -1;
+        // Best effort: grow the pipe to one message (capped by pipe-max-size)
+        fcntl(fds[1], F_SETPIPE_SZ, (int)MAX(msg, 65536UL));
+    }
+    if (pipe(ctl) != 0) {
+        close(fds[0]); close(fds[1]);
+        return -1;
+    }
+
+    memset(shared, 0, sizeof(*shared));
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(fds[0]); close(fds[1]); close(ctl[0]); close(ctl[1]);
+        return -1;
+    }
+    if (pid == 0) {
+        close(fds[0]);
+        close(ctl[1]);
+        pin_to_cpu(cpu_prod);
+        char go;
+        if (read(ctl[0], &go, 1) == 1) ipc_producer(method, fds[1], msg, total, shared);
+        close(fds[1]);
+        _exit(shared->error ? 1 : 0);
+    }
+
+    close(fds[1]);
+    close(ctl[0]);
+    pin_to_cpu(cpu_cons);
+    int devnull = open("/dev/null", O_WRONLY);
+
+    long calls = 0;
+    double t = get_time_sec();
+    if (write(ctl[1], "g", 1) != 1) shared->error = errno;
+    long got = ipc_consumer(method, fds[0], devnull, msg, total, &calls);
+    t = get_time_sec() - t;
+
+    close(fds[0]);
+    close(ctl[1]);
+    if (devnull >= 0) close(devnull);
+
+    int status = 0;
+    waitpid(pid, &status, 0);
+    if (got != (long)total || shared->error || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        return -1;
+    }
+
+    *syscalls = calls + shared->syscalls;
+    return t;
+}
+
+// In-process reference: the team memcpy()s total bytes from one buffer into a
+// separate one. Best payload GB/s over --iters passes (first is warm-up), or -1.
+static double ipc_copy_gbs(int num_threads, size_t total) {
+    char *src = (char *)alloc_aligned(ALIGN, total);
+    char *dst = (char *)alloc_aligned(ALIGN, total);
+    double mintime = 1e30;
+    if (src && dst) {
+        for (int k = -1; k < opts.iters; k++) {
+            double t = get_time_sec();
+            #pragma omp parallel num_threads(num_threads)
+            {
+                int tid = omp_get_thread_num(), nt = omp_get_num_threads();
+                size_t lo = (total * tid / nt) & ~(size_t)(ALIGN - 1);
+                size_t hi = tid == nt - 1 ? total : (total * (tid + 1) / nt) & ~(size_t)(ALIGN - 1);
+                // Pass -1 first-touches both buffers on the threads that copy them
+                if (k < 0) {
+                    memset(src + lo, 1, hi - lo);
+                    memset(dst + lo, 0, hi - lo);
+                } else {
+                    memcpy(dst + lo, src + lo, hi - lo);
+                }
+            }
+            t = get_time_sec() - t;
+            if (k > 0) mintime = MIN(mintime, t);
+        }
+    }
+    aligned_free(src);
+    aligned_free(dst);
+    return src && dst && mintime < 1e30 ? total / mintime / 1e9 : -1.0;
+}
+
+static int run_ipc(int num_threads, size_t array_size) {
+    static const size_t msg_sizes[] = { 4096, 16384, 65536, 262144, 1048576 };
+    const int num_sizes = (int)(sizeof(msg_sizes) / sizeof(msg_sizes[0]));
+    size_t total = array_size * sizeof(double);
+
+    cpu_set_t saved_mask;
+    sched_getaffinity(0, sizeof(saved_mask), &saved_mask);
+
+    int cpus[2];
+    if (topology_pick_cpus(2, cpus) == 0) {
+        fprintf(stderr, "Error: cannot read CPU affinity\n");
+        return 1;
+    }
+    if (cpus[0] == cpus[1]) {
+        fprintf(stderr, "Warning: only one CPU available, producer and consumer share it\n");
+    }
+
+    ipc_shared_t *shared = (ipc_shared_t *)mmap(NULL, sizeof(ipc_shared_t),
+        PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (shared == MAP_FAILED) {
+        fprintf(stderr, "Error: mmap: %s\n", strerror(errno));
+        return 1;
+    }
+
+    double copy_gbs = ipc_copy_gbs(num_threads, total);
+    if (copy_gbs <= 0.0) {
+        fprintf(stderr, "Memory allocation failed\n");
+        munmap(shared, sizeof(ipc_shared_t));
+        return 1;
+    }
+
+    printf("════════════════════════════════════════════════════════════\n");
+    printf("  UltraMem - Inter-Process Copy Bandwidth\n");
+    printf("════════════════════════════════════════════════════════════\n");
+    printf("  Bytes per test:    %.1f MB\n", (double)total / (1024.0 * 1024.0));
+    printf("  Producer CPU:      %d\n", cpus[0]);
+    printf("  Consumer CPU:      %d\n", cpus[1]);
+    printf("  In-process memcpy: %.2f GB/s (%d threads)\n", copy_gbs, num_threads);
+    printf("════════════════════════════════════════════════════════════\n\n");
+
+    printf("────────────────────────────────────────────────────────────\n");
+    printf("Method              Msg size      GB/s    Syscalls/s  vs copy\n");
+    printf("────────────────────────────────────────────────────────────\n");
+
+    for (int m = 0; m < IPC_NUM_METHODS; m++) {
+        for (int s = 0; s < num_sizes; s++) {
+            size_t msg = msg_sizes[s];
+            if (msg > total) break;
+            long syscalls = 0;
+            double t = ipc_run_one((ipc_method_t)m, msg, total, cpus[0], cpus[1],
+                                   shared, &syscalls);
+            if (t == -2) {
+                printf("%-18s  %8s  %8s  (SO_ZEROCOPY: %s)\n", ipc_method_names[m], "-", "n/a",
+                       strerror(errno));
+                break;
+            }
+            if (t <= 0) {
+                printf("%-18s  %6zu KB  %8s\n", ipc_method_names[m], msg / 1024, "failed");
+                continue;
+            }
+            double gbs = total / t / 1e9;
+            printf("%-18s  %6zu KB  %8.2f  %12.0f   %5.2fx\n", ipc_method_names[m],
+                   msg / 1024, gbs, syscalls / t, gbs / copy_gbs);
+        }
+    }
+    printf("────────────────────────────────────────────────────────────\n\n");
+
+    sched_setaffinity(0, sizeof(saved_mask), &saved_mask);
+    munmap(shared, sizeof(ipc_shared_t));
+    return 0;
+}
+#else
+static int run_ipc(int num_threads, size_t array_size) {
+    (void)num_threads; (void)array_size;
+    fprintf(stderr, "Error: --mode=ipc requires Linux\n");
+    return 1;
+}
+#endif
+
+// ============================================================================
+// Shared-memory SPSC / MPMC ring throughput and latency (Linux only)
+// ============================================================================
+
+#if defined(__linux__)
+#define RING_SLOTS          1024
+#define RING_MAX_WORKERS    64
+#define RING_LAT_SAMPLES    65536
+#define RING_MAX_MESSAGES   (1UL << 20)
+
+// Control block at the start of the memfd mapping. Producer- and
+// consumer-owned indices live on separate cache lines.
+typedef struct {
+    __attribute__((aligned(64))) uint64_t tail;   // SPSC write index / MPMC enqueue ticket
+    __attribute__((aligned(64))) uint64_t head;   // SPSC read index / MPMC dequeue ticket
+    __attribute__((aligned(64))) int ready;       // Workers pinned and waiting
+    int failed;                                   // Workers that could not start
+    int start;                                    // Released by the launcher
+    int abort;                                    // Set with start: exit without running
+    ring_kind_t kind;
+    size_t msg_size;        // Bytes per message, first 8 are the TSC stamp
+    size_t slot_size;       // 8-byte sequence + message, padded to a cache line
+    int batch;
+    uint64_t total;         // Messages across all producers
+    uint64_t lat_stride;    // Record every lat_stride-th message per consumer
+    uint64_t lat_count[RING_MAX_WORKERS];
+} ring_ctl_t;
+
+typedef struct {
+    ring_ctl_t *ctl;
+    char *slots;
+    uint64_t *lat;          // RING_LAT_SAMPLES per consumer
+    int consumer;           // 0 = producer, 1 = consumer
+    int index;
+    int cpu;
+} ring_worker_t;
+
+static void ring_put(char *slot, const char *src, size_t msg) {
+    uint64_t stamp = tsc_now();
+    memcpy(slot + 8, &stamp, sizeof(stamp));
+    memcpy(slot + 16, src, msg - 8);
+}
+
+static void ring_get(ring_worker_t *w, const char *slot, char *dst, uint64_t *n) {
+    ring_ctl_t *ctl = w->ctl;
+    memcpy(dst, slot + 8, ctl->msg_size);
+    if (*n % ctl->lat_stride == 0 && ctl->lat_count[w->index] < RING_LAT_SAMPLES) {
+        uint64_t stamp;
+        memcpy(&stamp, dst, sizeof(stamp));
+        w->lat[ctl->lat_count[w->index]++] = tsc_now() - stamp;
+    }
+    (*n)++;
+}
+
+static void ring_spsc_producer(ring_worker_t *w, const char *src) {
+    ring_ctl_t *ctl = w->ctl;
+    uint64_t tail = 0, head_cache = 0;
+    unsigned spins = 0;
+    while (tail < ctl->total) {
+        uint64_t n = MIN((uint64_t)ctl->batch, ctl->total - tail);
+        while (tail + n - head_cache > RING_SLOTS) {
+            head_cache = __atomic_load_n(&ctl->head, __ATOMIC_ACQUIRE);
+            if (tail + n - head_cache > RING_SLOTS) spin_relax(&spins);
+        }
+        for (uint64_t i = 0; i < n; i++) {
+            ring_put(w->slots + ((tail + i) % RING_SLOTS) * ctl->slot_size, src, ctl->msg_size);
+        }
+        tail += n;
+        __atomic_store_n(&ctl->tail, tail, __ATOMIC_RELEASE);
+    }
+}
+
+static void ring_spsc_consumer(ring_worker_t *w, char *dst) {
+    ring_ctl_t *ctl = w->ctl;
+    uint64_t head = 0, tail_cache = 0, seen = 0;
+    unsigned spins = 0;
+    while (head < ctl->total) {
+        while (head == tail_cache) {
+            tail_cache = __atomic_load_n(&ctl->tail, __ATOMIC_ACQUIRE);
+            if (head == tail_cache) spin_relax(&spins);
+        }
+        uint64_t n = MIN((uint64_t)ctl->batch, tail_cache - head);
+        for (uint64_t i = 0; i < n; i++) {
+            ring_get(w, w->slots + ((head + i) % RING_SLOTS) * ctl->slot_size, dst, &seen);
+        }
+        head += n;
+        __atomic_store_n(&ctl->head, head, __ATOMIC_RELEASE);
     }
-    
+}
+
+// Bounded MPMC: each slot carries a sequence number. A producer claims a run
+// of tickets, waits until each slot's sequence equals its ticket (slot free),
+// fills it and publishes ticket + 1. A consumer waits for ticket + 1, drains
+// the slot and releases it for the next lap with ticket + RING_SLOTS.
+static void ring_mpmc_producer(ring_worker_t *w, const char *src) {
+    ring_ctl_t *ctl = w->ctl;
+    unsigned spins = 0;
+    for (;;) {
+        uint64_t pos = __atomic_fetch_add(&ctl->tail, (uint64_t)ctl->batch, __ATOMIC_RELAXED);
+        if (pos >= ctl->total) break;
+        uint64_t n = MIN((uint64_t)ctl->batch, ctl->total - pos);
+        for (uint64_t i = 0; i < n; i++) {
+            char *slot = w->slots + ((pos + i) % RING_SLOTS) * ctl->slot_size;
+            uint64_t *seq = (uint64_t *)slot;
+            while (__atomic_load_n(seq, __ATOMIC_ACQUIRE) != pos + i) spin_relax(&spins);
+            ring_put(slot, src, ctl->msg_size);
+            __atomic_store_n(seq, pos + i + 1, __ATOMIC_RELEASE);
+        }
+    }
+}
+
+static void ring_mpmc_consumer(ring_worker_t *w, char *dst) {
+    ring_ctl_t *ctl = w->ctl;
+    uint64_t seen = 0;
+    unsigned spins = 0;
+    for (;;) {
+        uint64_t pos = __atomic_fetch_add(&ctl->head, (uint64_t)ctl->batch, __ATOMIC_RELAXED);
+        if (pos >= ctl->total) break;
+        uint64_t n = MIN((uint64_t)ctl->batch, ctl->total - pos);
+        for (uint64_t i = 0; i < n; i++) {
+            char *slot = w->slots + ((pos + i) % RING_SLOTS) * ctl->slot_size;
+            uint64_t *seq = (uint64_t *)slot;
+            while (__atomic_load_n(seq, __ATOMIC_ACQUIRE) != pos + i + 1) spin_relax(&spins);
+            ring_get(w, slot, dst, &seen);
+            __atomic_store_n(seq, pos + i + RING_SLOTS, __ATOMIC_RELEASE);
+        }
+    }
+}
+
+static void *ring_worker(void *arg) {
+    ring_worker_t *w = (ring_worker_t *)arg;
+    ring_ctl_t *ctl = w->ctl;
+    unsigned spins = 0;
+
+    pin_to_cpu(w->cpu);
+    char *buf = (char *)alloc_aligned(ALIGN, ctl->msg_size);
+    if (!buf) {
+        __atomic_fetch_add(&ctl->failed, 1, __ATOMIC_ACQ_REL);
+        return NULL;
+    }
+    memset(buf, w->index + 1, ctl->msg_size);
+
+    __atomic_fetch_add(&ctl->ready, 1, __ATOMIC_ACQ_REL);
+    while (!__atomic_load_n(&ctl->start, __ATOMIC_ACQUIRE)) spin_relax(&spins);
+    if (__atomic_load_n(&ctl->abort, __ATOMIC_ACQUIRE)) {
+        aligned_free(buf);
+        return NULL;
+    }
+
+    if (ctl->kind == RING_SPSC) {
+        if (w->consumer) ring_spsc_consumer(w, buf);
+        else ring_spsc_producer(w, buf);
+    } else {
+        if (w->consumer) ring_mpmc_consumer(w, buf);
+        else ring_mpmc_producer(w, buf);
+    }
+
+    aligned_free(buf);
+    return NULL;
+}
+
+static int cmp_u64(const void *x, const void *y) {
+    uint64_t p = *(const uint64_t *)x, q = *(const uint64_t *)y;
+    return (p > q) - (p < q);
+}
+
+typedef struct {
+    double seconds;
+    double p50_ns, p99_ns;
+} ring_result_t;
+
+// One run over a fresh memfd mapping; workers are threads or processes
+static int ring_run_one(ring_kind_t kind, int producers, int consumers, const int *cpus,
+                        size_t msg, int batch, uint64_t total, ring_result_t *res) {
+    size_t slot_size = (8 + msg + ALIGN - 1) / ALIGN * ALIGN;
+    size_t ctl_size = (sizeof(ring_ctl_t) + 4095) & ~(size_t)4095;
+    size_t lat_size = (size_t)consumers * RING_LAT_SAMPLES * sizeof(uint64_t);
+    size_t map_size = ctl_size + RING_SLOTS * slot_size + lat_size;
+
+    int fd = memfd_create("ultramem-ring", 0);
+    if (fd < 0 || ftruncate(fd, (off_t)map_size) != 0) {
+        if (fd >= 0) close(fd);
+        return -1;
+    }
+    char *base = (char *)mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) return -1;
+
+    ring_ctl_t *ctl = (ring_ctl_t *)base;
+    char *slots = base + ctl_size;
+    uint64_t *lat = (uint64_t *)(slots + RING_SLOTS * slot_size);
+
+    ctl->kind = kind;
+    ctl->msg_size = msg;
+    ctl->slot_size = slot_size;
+    ctl->batch = batch;
+    ctl->total = total;
+    ctl->lat_stride = MAX(1, total / RING_LAT_SAMPLES);
+    for (uint64_t i = 0; i < RING_SLOTS; i++) {
+        *(uint64_t *)(slots + i * slot_size) = i;
+    }
+
+    int nworkers = producers + consumers, started = 0, err = 0;
+    ring_worker_t workers[2 * RING_MAX_WORKERS];
+    pthread_t threads[2 * RING_MAX_WORKERS];
+    pid_t pids[2 * RING_MAX_WORKERS];
+    for (int i = 0; i < nworkers; i++, started++) {
+        ring_worker_t *w = &workers[i];
+        w->ctl = ctl;
+        w->slots = slots;
+        w->consumer = i >= producers;
+        w->index = w->consumer ? i - producers : i;
+        w->lat = lat + (size_t)(w->consumer ? w->index : 0) * RING_LAT_SAMPLES;
+        w->cpu = cpus[i];
+        if (opts.ring_procs) {
+            pids[i] = fork();
+            if (pids[i] < 0) {
+                err = errno;
+                break;
+            }
+            if (pids[i] == 0) {
+                ring_worker(w);
+                _exit(0);
+            }
+        } else if ((err = pthread_create(&threads[i], NULL, ring_worker, w)) != 0) {
+            break;
+        }
+    }
+
+    // Every started worker either waits on start or has given up
+    unsigned spins = 0;
+    while (__atomic_load_n(&ctl->ready, __ATOMIC_ACQUIRE) +
+           __atomic_load_n(&ctl->failed, __ATOMIC_ACQUIRE) < started) spin_relax(&spins);
+    if (!err && ctl->failed > 0) err = ENOMEM;
+    if (err) __atomic_store_n(&ctl->abort, 1, __ATOMIC_RELEASE);
+    double t = get_time_sec();
+    __atomic_store_n(&ctl->start, 1, __ATOMIC_RELEASE);
+
+    for (int i = 0; i < started; i++) {
+        if (opts.ring_procs) waitpid(pids[i], NULL, 0);
+        else pthread_join(threads[i], NULL);
+    }
+    res->seconds = get_time_sec() - t;
+    if (err) {
+        munmap(base, map_size);
+        errno = err;
+        return -1;
+    }
+
+    // Pool the consumers' one-way latency samples
+    size_t nlat = 0;
+    for (int i = 0; i < consumers; i++) {
+        memmove(lat + nlat, lat + (size_t)i * RING_LAT_SAMPLES, ctl->lat_count[i] * sizeof(uint64_t));
+        nlat += ctl->lat_count[i];
+    }
+    res->p50_ns = res->p99_ns = 0.0;
+    if (nlat > 0) {
+        double ns_per_tick = 1e9 / tsc_ticks_per_sec();
+        qsort(lat, nlat, sizeof(uint64_t), cmp_u64);
+        res->p50_ns = lat[nlat * 50 / 100] * ns_per_tick;
+        res->p99_ns = lat[nlat * 99 / 100] * ns_per_tick;
+    }
+
+    munmap(base, map_size);
+    return 0;
+}
+
+static int run_ring(int num_threads, size_t array_size) {
+    static const size_t msg_sizes[] = { 64, 256, 1024, 4096 };
+    static const int batches[] = { 1, 8, 32 };
+    const int num_sizes = (int)(sizeof(msg_sizes) / sizeof(msg_sizes[0]));
+    const int num_batches = (int)(sizeof(batches) / sizeof(batches[0]));
+
+    // MPMC splits the thread count between producers and consumers
+    int mpmc_prod = MIN(MAX(num_threads / 2, 1), RING_MAX_WORKERS);
+    int mpmc_cons = MIN(MAX(num_threads - mpmc_prod, 1), RING_MAX_WORKERS);
+    int cpus[2 * RING_MAX_WORKERS];
+    if (topology_pick_cpus(mpmc_prod + mpmc_cons, cpus) == 0) {
+        fprintf(stderr, "Error: cannot read CPU affinity\n");
+        return 1;
+    }
+    tsc_ticks_per_sec();
+
+    printf("════════════════════════════════════════════════════════════\n");
+    printf("  UltraMem - Shared-Memory Ring Throughput and Latency\n");
+    printf("════════════════════════════════════════════════════════════\n");
+    printf("  Workers:           %s over memfd\n", opts.ring_procs ? "processes" : "threads");
+    printf("  Ring slots:        %d\n", RING_SLOTS);
+    printf("  SPSC CPUs:         %d -> %d\n", cpus[0], cpus[1 % (mpmc_prod + mpmc_cons)]);
+    printf("  MPMC:              %d producers, %d consumers\n", mpmc_prod, mpmc_cons);
+    printf("  Timestamp clock:   %.3f GHz counter\n", tsc_ticks_per_sec() / 1e9);
+    printf("════════════════════════════════════════════════════════════\n\n");
+
     printf("────────────────────────────────────────────────────────────\n");
-    printf("Kernel      Best MB/s    Avg MB/s     Min Time     Max Time\n");
+    printf("Ring   Msg B  Batch    Mmsg/s      GB/s    p50 ns    p99 ns\n");
     printf("────────────────────────────────────────────────────────────\n");
-    
-    double avgtime = 0.0;
-    double mintime = times[1];
-    double maxtime = times[1];
-    
-    for (int k = 1; k < NTIMES; k++) {
-        avgtime += times[k];
-        mintime = MIN(mintime, times[k]);
-        maxtime = MAX(maxtime, times[k]);
+
+    for (int k = RING_SPSC; k <= RING_MPMC; k++) {
+        if (opts.ring_kind != RING_BOTH && opts.ring_kind != (ring_kind_t)k) continue;
+        int producers = k == RING_SPSC ? 1 : mpmc_prod;
+        int consumers = k == RING_SPSC ? 1 : mpmc_cons;
+        int spsc_cpus[2] = { cpus[0], cpus[1 % (mpmc_prod + mpmc_cons)] };
+
+        for (int s = 0; s < num_sizes; s++) {
+            size_t msg = msg_sizes[s];
+            uint64_t total = MAX(MIN(array_size * sizeof(double) / msg, RING_MAX_MESSAGES), RING_SLOTS);
+            for (int bi = 0; bi < num_batches; bi++) {
+                ring_result_t res;
+                if (ring_run_one((ring_kind_t)k, producers, consumers,
+                                 k == RING_SPSC ? spsc_cpus : cpus,
+                                 msg, batches[bi], total, &res) != 0) {
+                    fprintf(stderr, "Error: ring setup failed: %s\n", strerror(errno));
+                    return 1;
+                }
+                printf("%-5s  %5zu  %5d  %8.2f  %8.2f  %8.0f  %8.0f\n",
+                       k == RING_SPSC ? "spsc" : "mpmc", msg, batches[bi],
+                       total / res.seconds / 1e6, total * msg / res.seconds / 1e9,
+                       res.p50_ns, res.p99_ns);
+            }
+        }
     }
-    avgtime /= (NTIMES - 1);
-    
-    double best_bw = total_bytes / mintime / 1e6;
-    double avg_bw = total_bytes / avgtime / 1e6;
-    
-    char label[16];
-    snprintf(label, sizeof(label), "%d:%d", reads, writes);
-    
-    printf("%-8s  %10.1f  %10.1f   %10.6f   %10.6f\n",
-           label, best_bw, avg_bw, mintime, maxtime);
-    
-    printf("────────────────────────────────────────────────────────────\n");
-    printf("\n");
+    printf("────────────────────────────────────────────────────────────\n\n");
+    return 0;
+}
+#else
+static int run_ring(int num_threads, size_t array_size) {
+    (void)num_threads; (void)array_size;
+    fprintf(stderr, "Error: --mode=ring requires Linux\n");
+    return 1;
+}
+#endif
+
+// ============================================================================
+// Magic (double-mapped) ring vs split-copy ring streaming (Linux only)
+// ============================================================================
+
+#if defined(__linux__)
+#define MRING_MAX_RECORD 4096   // Largest record incl. 8-byte length header
+
+typedef struct {
+    __attribute__((aligned(64))) uint64_t tail;   // Bytes produced
+    __attribute__((aligned(64))) uint64_t head;   // Bytes consumed
+    __attribute__((aligned(64))) char *ring;
+    size_t size;            // Power of two, multiple of the page size
+    int magic;              // Ring is mapped twice back to back
+    uint64_t total;         // Bytes to stream (headers included)
+    uint64_t records;
+    int cpus[2];
+    int error;              // Set atomically by either side; both waits give up on it
+} mring_t;
+
+// Map a memfd of size bytes, optionally a second time right after the first
+// so that accesses running past the end land at the start of the buffer
+static char *mring_map(size_t size, int twice) {
+    int fd = memfd_create("ultramem-mring", 0);
+    if (fd < 0) return NULL;
+    if (ftruncate(fd, (off_t)size) != 0) {
+        close(fd);
+        return NULL;
+    }
+
+    size_t span = twice ? 2 * size : size;
+    char *base = (char *)mmap(NULL, span, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) {
+        close(fd);
+        return NULL;
+    }
+    for (size_t off = 0; off < span; off += size) {
+        if (mmap(base + off, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_FIXED,
+                 fd, 0) == MAP_FAILED) {
+            munmap(base, span);
+            close(fd);
+            return NULL;
+        }
+    }
+    close(fd);
+    return base;
+}
+
+static inline uint32_t mring_next_len(uint32_t *state) {
+    // xorshift32; record lengths are 8-byte multiples in [16, MRING_MAX_RECORD]
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return 16 + (x % ((MRING_MAX_RECORD - 16) / 8 + 1)) * 8;
+}
+
+static inline void mring_write(mring_t *r, uint64_t pos, const void *src, size_t len) {
+    size_t off = pos & (r->size - 1);
+    if (r->magic || off + len <= r->size) {
+        memcpy(r->ring + off, src, len);
+    } else {
+        size_t first = r->size - off;
+        memcpy(r->ring + off, src, first);
+        memcpy(r->ring, (const char *)src + first, len - first);
+    }
+}
+
+static inline void mring_read(mring_t *r, uint64_t pos, void *dst, size_t len) {
+    size_t off = pos & (r->size - 1);
+    if (r->magic || off + len <= r->size) {
+        memcpy(dst, r->ring + off, len);
+    } else {
+        size_t first = r->size - off;
+        memcpy(dst, r->ring + off, first);
+        memcpy((char *)dst + first, r->ring, len - first);
+    }
+}
+
+static void *mring_producer(void *arg) {
+    mring_t *r = (mring_t *)arg;
+    char src[MRING_MAX_RECORD];
+    uint64_t tail = 0, head_cache = 0;
+    uint32_t state = 2463534242u;
+    unsigned spins = 0;
+
+    pin_to_cpu(r->cpus[0]);
+    memset(src, 0x5a, sizeof(src));
+    while (tail < r->total) {
+        uint64_t len = mring_next_len(&state);
+        while (tail + len - head_cache > r->size) {
+            if (__atomic_load_n(&r->error, __ATOMIC_ACQUIRE)) return NULL;
+            head_cache = __atomic_load_n(&r->head, __ATOMIC_ACQUIRE);
+            if (tail + len - head_cache > r->size) spin_relax(&spins);
+        }
+        memcpy(src, &len, sizeof(len));
+        mring_write(r, tail, src, len);
+        tail += len;
+        __atomic_store_n(&r->tail, tail, __ATOMIC_RELEASE);
+    }
+    return NULL;
+}
+
+static void *mring_consumer(void *arg) {
+    mring_t *r = (mring_t *)arg;
+    char dst[MRING_MAX_RECORD];
+    uint64_t head = 0, tail_cache = 0, records = 0;
+    uint32_t state = 2463534242u;
+    unsigned spins = 0;
+
+    pin_to_cpu(r->cpus[1]);
+    while (head < r->total) {
+        while (head == tail_cache) {
+            if (__atomic_load_n(&r->error, __ATOMIC_ACQUIRE)) return NULL;
+            tail_cache = __atomic_load_n(&r->tail, __ATOMIC_ACQUIRE);
+            if (head == tail_cache) spin_relax(&spins);
+        }
+        while (head < tail_cache) {
+            uint64_t len;
+            mring_read(r, head, &len, sizeof(len));
+            if (len != mring_next_len(&state)) {
+                __atomic_store_n(&r->error, 1, __ATOMIC_RELEASE);
+                return NULL;
+            }
+            mring_read(r, head, dst, len);
+            head += len;
+            records++;
+        }
+        __atomic_store_n(&r->head, head, __ATOMIC_RELEASE);
+    }
+    r->records = records;
+    return NULL;
+}
+
+// Stream total bytes through one ring; returns seconds or -1
+static double mring_run_one(size_t size, int magic, uint64_t total, const int *cpus,
+                            uint64_t *records) {
+    mring_t r;
+    memset(&r, 0, sizeof(r));
+    r.size = size;
+    r.magic = magic;
+    r.total = total;
+    r.cpus[0] = cpus[0];
+    r.cpus[1] = cpus[1];
+    r.ring = mring_map(size, magic);
+    if (!r.ring) return -1.0;
+    memset(r.ring, 0, size);
+
+    pthread_t prod, cons;
+    double t = get_time_sec();
+    if (pthread_create(&cons, NULL, mring_consumer, &r) != 0) {
+        munmap(r.ring, magic ? 2 * size : size);
+        return -1.0;
+    }
+    if (pthread_create(&prod, NULL, mring_producer, &r) == 0) pthread_join(prod, NULL);
+    else __atomic_store_n(&r.error, 1, __ATOMIC_RELEASE);
+    pthread_join(cons, NULL);
+    t = get_time_sec() - t;
+
+    munmap(r.ring, magic ? 2 * size : size);
+    *records = r.records;
+    return r.error ? -1.0 : t;
+}
+
+static size_t round_up_pow2(size_t v) {
+    size_t p = 1;
+    while (p < v) p <<= 1;
+    return p;
+}
+
+static int run_mring(size_t array_size, cache_info_t *cache) {
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t sizes[3] = {
+        round_up_pow2(MAX(cache->l2_size, page)),
+        round_up_pow2(MAX(cache->l3_size, page)),
+        round_up_pow2(MAX(cache->l3_size * 4, page)),
+    };
+    static const char *size_labels[3] = { "L2", "L3", "DRAM (4x L3)" };
+
+    int cpus[2];
+    if (topology_pick_cpus(2, cpus) == 0) {
+        fprintf(stderr, "Error: cannot read CPU affinity\n");
+        return 1;
+    }
+
     printf("════════════════════════════════════════════════════════════\n");
-    printf("  PEAK BANDWIDTH: %.1f MB/s (%.2f GB/s)\n", best_bw, best_bw / 1000.0);
+    printf("  UltraMem - Magic Ring vs Split-Copy Ring\n");
+    printf("════════════════════════════════════════════════════════════\n");
+    printf("  Producer CPU:      %d\n", cpus[0]);
+    printf("  Consumer CPU:      %d\n", cpus[1]);
+    printf("  Record sizes:      16 - %d bytes (8-byte header)\n", MRING_MAX_RECORD);
     printf("════════════════════════════════════════════════════════════\n\n");
-    
-    if (dummy_sum < -1e30) printf("%f", dummy_sum);
-    
-    aligned_free(a);
-    aligned_free(b);
-    aligned_free(c);
+
+    printf("────────────────────────────────────────────────────────────────────\n");
+    printf("Ring size            Layout      GB/s    Mrec/s    Speedup\n");
+    printf("────────────────────────────────────────────────────────────────────\n");
+
+    for (int s = 0; s < 3; s++) {
+        if (s > 0 && sizes[s] == sizes[s - 1]) continue;
+        uint64_t total = MAX((uint64_t)array_size * sizeof(double), 4 * (uint64_t)sizes[s]);
+        double gbs[2] = {0.0, 0.0};
+        for (int magic = 0; magic <= 1; magic++) {
+            uint64_t records = 0;
+            double t = mring_run_one(sizes[s], magic, total, cpus, &records);
+            char label[32];
+            if (sizes[s] >= 1024 * 1024) snprintf(label, sizeof(label), "%zu MB", sizes[s] >> 20);
+            else snprintf(label, sizeof(label), "%zu KB", sizes[s] >> 10);
+            if (t < 0) {
+                // Mapping, thread start or a corrupted record
+                printf("%-7s %-12s %-8s  %8s\n", label, magic ? "" : size_labels[s],
+                       magic ? "magic" : "split", "failed");
+                continue;
+            }
+            gbs[magic] = total / t / 1e9;
+            printf("%-7s %-12s %-8s  %8.2f  %8.2f", label, magic ? "" : size_labels[s],
+                   magic ? "magic" : "split", gbs[magic], records / t / 1e6);
+            if (magic && gbs[0] > 0.0) printf("    %6.2fx", gbs[1] / gbs[0]);
+            printf("\n");
+        }
+    }
+    printf("────────────────────────────────────────────────────────────────────\n\n");
+    return 0;
+}
+#else
+static int run_mring(size_t array_size, cache_info_t *cache) {
+    (void)array_size; (void)cache;
+    fprintf(stderr, "Error: --mode=magicring requires Linux\n");
+    return 1;
+}
+#endif
+
+// ============================================================================
+// Cross-process copy: process_vm_readv / process_vm_writev (Linux only)
+// ============================================================================
+
+#if defined(__linux__)
+#define PVM_MAX_IOV 1024    // UIO_MAXIOV
+#define PVM_REPEATS 3       // Passes per configuration (best is reported)
+
+// One pass over bytes with iov_count iovecs of iov_size per syscall, split
+// across the OpenMP team. A call never covers more than one thread's share,
+// so large iovec counts still give every thread work. Returns seconds, or -1
+// if a call failed.
+static double pvm_pass(pid_t pid, char *local, char *remote, size_t bytes,
+                       size_t iov_size, int iov_count, int do_write) {
+    size_t chunk = iov_size * (size_t)iov_count;
+    size_t share = bytes / (size_t)omp_get_max_threads() / iov_size * iov_size;
+    if (share >= iov_size) chunk = MIN(chunk, share);
+    size_t ncalls = (bytes + chunk - 1) / chunk;
+    int err = 0;
+
+    double t = get_time_sec();
+    #pragma omp parallel for schedule(static) reduction(|:err)
+    for (size_t k = 0; k < ncalls; k++) {
+        struct iovec liov[PVM_MAX_IOV], riov[PVM_MAX_IOV];
+        size_t off = k * chunk, end = MIN(off + chunk, bytes);
+        unsigned long cnt = 0;
+        for (size_t o = off; o < end; o += iov_size, cnt++) {
+            liov[cnt].iov_base = local + o;
+            riov[cnt].iov_base = remote + o;
+            liov[cnt].iov_len = riov[cnt].iov_len = MIN(iov_size, end - o);
+        }
+        ssize_t n = do_write ? process_vm_writev(pid, liov, cnt, riov, cnt, 0)
+                             : process_vm_readv(pid, liov, cnt, riov, cnt, 0);
+        if (n != (ssize_t)(end - off)) err = 1;
+    }
+    t = get_time_sec() - t;
+
+    return err ? -1.0 : t;
+}
+
+static double pvm_best_gbs(pid_t pid, char *local, char *remote, size_t bytes,
+                           size_t iov_size, int iov_count, int do_write) {
+    double best = 1e30;
+    for (int r = 0; r < PVM_REPEATS; r++) {
+        double t = pvm_pass(pid, local, remote, bytes, iov_size, iov_count, do_write);
+        if (t < 0) return -1.0;
+        best = MIN(best, t);
+    }
+    return bytes / best / 1e9;
+}
+
+// Same data through a MAP_SHARED mapping the child also holds
+static double pvm_shm_gbs(char *local, const char *shm, size_t bytes) {
+    double best = 1e30;
+    for (int r = 0; r < PVM_REPEATS; r++) {
+        double t = get_time_sec();
+        #pragma omp parallel
+        {
+            int tid = omp_get_thread_num(), nt = omp_get_num_threads();
+            size_t per = (bytes / nt + 4095) & ~(size_t)4095;
+            size_t lo = MIN((size_t)tid * per, bytes), hi = MIN(lo + per, bytes);
+            memcpy(local + lo, shm + lo, hi - lo);
+        }
+        best = MIN(best, get_time_sec() - t);
+    }
+    return bytes / best / 1e9;
+}
+
+static int run_pvm(int num_threads, size_t array_size) {
+    static const size_t iov_sizes[] = { 4096, 65536, 1048576 };
+    static const int iov_counts[] = { 1, 64, PVM_MAX_IOV };
+    const int num_sizes = (int)(sizeof(iov_sizes) / sizeof(iov_sizes[0]));
+    const int num_counts = (int)(sizeof(iov_counts) / sizeof(iov_counts[0]));
+    size_t bytes = array_size * sizeof(double);
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+
+    char *shm = (char *)mmap(NULL, bytes, PROT_READ | PROT_WRITE,
+                             MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    int to_child[2], from_child[2];
+    if (shm == MAP_FAILED || pipe(to_child) != 0 || pipe(from_child) != 0) {
+        fprintf(stderr, "Error: setup failed: %s\n", strerror(errno));
+        return 1;
+    }
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        fprintf(stderr, "Error: fork: %s\n", strerror(errno));
+        return 1;
+    }
+    if (pid == 0) {
+        // Child: own a DRAM-sized array and fill the shared one, then wait
+        close(to_child[1]);
+        close(from_child[0]);
+        char *remote = (char *)alloc_aligned(page, bytes);
+        if (remote) {
+            memset(remote, 1, bytes);
+            memset(shm, 1, bytes);
+        }
+        if (write(from_child[1], &remote, sizeof(remote)) != sizeof(remote)) _exit(1);
+        char c;
+        while (read(to_child[0], &c, 1) > 0) { }
+        _exit(0);
+    }
+
+    close(to_child[0]);
+    close(from_child[1]);
+    char *remote = NULL;
+    if (read(from_child[0], &remote, sizeof(remote)) != sizeof(remote) || !remote) {
+        fprintf(stderr, "Error: child failed to allocate %zu bytes\n", bytes);
+        close(to_child[1]);
+        waitpid(pid, NULL, 0);
+        return 1;
+    }
+
+    omp_set_num_threads(num_threads);
+    char *local = (char *)alloc_aligned(page, bytes);
+    if (!local) {
+        fprintf(stderr, "Memory allocation failed\n");
+        close(to_child[1]);
+        waitpid(pid, NULL, 0);
+        return 1;
+    }
+    #pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < bytes; i += page) local[i] = 0;
+
+    printf("════════════════════════════════════════════════════════════\n");
+    printf("  UltraMem - Cross-Process Copy (process_vm_readv/writev)\n");
+    printf("════════════════════════════════════════════════════════════\n");
+    printf("  Child PID:         %d\n", (int)pid);
+    printf("  Bytes per pass:    %.1f MB\n", (double)bytes / (1024.0 * 1024.0));
+    printf("  Max threads:       %d\n", num_threads);
+    printf("  Passes:            best of %d\n", PVM_REPEATS);
+    printf("════════════════════════════════════════════════════════════\n\n");
+
+    printf("────────────────────────────────────────────────────────────────────\n");
+    printf("Threads  Iov size  Iov count   readv GB/s  writev GB/s   shm GB/s\n");
+    printf("────────────────────────────────────────────────────────────────────\n");
+
+    int ret = 0;
+    for (int t = 1; t <= num_threads && ret == 0; t = next_pow2_count(t, num_threads)) {
+        omp_set_num_threads(t);
+        double shm_gbs = pvm_shm_gbs(local, shm, bytes);
+        for (int s = 0; s < num_sizes && ret == 0; s++) {
+            for (int k = 0; k < num_counts; k++) {
+                double rd = pvm_best_gbs(pid, local, remote, bytes, iov_sizes[s], iov_counts[k], 0);
+                double wr = pvm_best_gbs(pid, local, remote, bytes, iov_sizes[s], iov_counts[k], 1);
+                if (rd < 0 || wr < 0) {
+                    fprintf(stderr, "Error: process_vm_%sv: %s\n", rd < 0 ? "read" : "write",
+                            strerror(errno));
+                    ret = 1;
+                    break;
+                }
+                printf("%7d  %6zu KB  %9d   %10.2f  %11.2f   %8.2f\n",
+                       t, iov_sizes[s] / 1024, iov_counts[k], rd, wr, shm_gbs);
+            }
+        }
+    }
+    printf("────────────────────────────────────────────────────────────────────\n\n");
+
+    close(to_child[1]);
+    waitpid(pid, NULL, 0);
+    aligned_free(local);
+    munmap(shm, bytes);
+    return ret;
+}
+#else
+static int run_pvm(int num_threads, size_t array_size) {
+    (void)num_threads; (void)array_size;
+    fprintf(stderr, "Error: --mode=pvm requires Linux\n");
+    return 1;
 }
+#endif
 
 void print_usage(const char *prog) {
-    printf("Usage: %s <num_threads> <reads:writes> [array_size_mb]\n", prog);
+    printf("Usage: %s <num_threads> <reads:writes> [array_size] [options]\n", prog);
     printf("\nArguments:\n");
     printf("  num_threads    Number of OpenMP threads\n");
     printf("  reads:writes   Memory access pattern (e.g., 1:1, 2:1, 1:0, 0:1)\n");
-    printf("  array_size_mb  Size of each array in MB (default: 4x L3 cache)\n");
+    printf("  array_size     Size of each array: MB, or bytes with K/M/G suffix\n");
+    printf("                 (e.g. 16K for L1; default: 4x L3 cache)\n");
+    printf("\nOptions:\n");
+    printf("  --mode=MODE    bench (default), iouring, ipc, ring, pvm, magicring,\n");
+    printf("                 thread-sweep, size-sweep, smt, hybrid, schedule, forkjoin,\n");
+    printf("                 l3domains, interfere, loadgen, lownoise\n");
+    printf("  --file=PATH    Input file or block device (iouring)\n");
+    printf("  --qd=N         io_uring queue depth (default: 32)\n");
+    printf("  --bs=SIZE      I/O block size, power of two, e.g. 128K (default: 1M)\n");
+    printf("  --fixed        Register buffers with io_uring\n");
+    printf("  --pipeline     Also run the 1:0 kernel overlapped with the reads\n");
+    printf("  --ring=KIND    spsc, mpmc or both (default: both)\n");
+    printf("  --procs        Run ring producers/consumers as processes\n");
+    printf("  --bind=POLICY  none (default), compact, scatter, core, or a CPU list (0,2,4-7)\n");
+    printf("  --backend=B    omp (default) or pthread (persistent pinned team)\n");
+    printf("  --per-thread   Time each thread's slice; report spread and fairness\n");
+    printf("  --noise        Record IRQs, switches and migrations per iteration (Linux)\n");
+    printf("  --timer=T      clock (CLOCK_MONOTONIC_RAW, default) or tsc (invariant RDTSCP)\n");
+    printf("  --force        Report results shorter than 100x the timer resolution\n");
+    printf("  --iters=N      Timed iterations including one warm-up (default: %d)\n", NTIMES);
+    printf("  --adaptive[=P] Iterate until the median's 95%% CI is within P%% (default 1)\n");
+    printf("  --budget=S     Time limit for --adaptive in seconds (default: 30)\n");
+    printf("  --schedule=S   static (default), dynamic, guided or steal, with optional\n");
+    printf("                 :line, :page or :SIZE chunk (default 64K)\n");
+    printf("  --patterns=L   Patterns for sweeps, e.g. 1:1,2:1,1:0,0:1 (default: the pattern)\n");
+    printf("  --steps=S      Thread-sweep steps: pow2 (default) or linear\n");
+    printf("  --csv=PATH     Also write size-sweep results as CSV\n");
+    printf("  --probe-cache  Measure L1/L2/L3 sizes from latency knees; show next to detected\n");
+    printf("  --auto-size=S  detected (default) or empirical: cache sizes from --probe-cache\n");
+    printf("  --victim=L     Interfere victims: reads:writes and/or latency (default: the pattern)\n");
+    printf("  --rate=GBPS    Loadgen target bandwidth in GB/s (default: unlimited)\n");
+    printf("  --duration=S   Seconds to run; bench logs a bandwidth time series (loadgen: 10)\n");
     printf("\nPattern format: reads:writes (any values 0-100)\n");
     printf("  Bytes transferred = (reads + writes) * 8 bytes per element\n");
     printf("\nCommon patterns:\n");
@@ -532,15 +5633,270 @@ void print_usage(const char *prog) {
     printf("  %s 8 1:1           # 8 threads, copy pattern\n", prog);
     printf("  %s 32 2:1 1024     # 32 threads, triad, 1GB arrays\n", prog);
     printf("  %s 96 0:1          # 96 threads, write-only\n", prog);
+    printf("  %s 8 1:0 8K        # 8 threads, read-only, L1-resident blocks\n", prog);
+    printf("  %s 8 1:0 4096 --mode=iouring --file=/data/big --qd=64 --pipeline\n", prog);
+}
+
+// Parse a byte count with optional K/M/G suffix (powers of 1024)
+static int parse_size(const char *s, size_t *out) {
+    char *end;
+    int shift = 0;
+    // strtoull would accept and negate a leading '-'
+    if (*s < '0' || *s > '9') return -1;
+    errno = 0;
+    unsigned long long v = strtoull(s, &end, 10);
+    if (end == s || errno != 0) return -1;
+    switch (*end) {
+        case 'k': case 'K': shift = 10; end++; break;
+        case 'm': case 'M': shift = 20; end++; break;
+        case 'g': case 'G': shift = 30; end++; break;
+    }
+    if (*end == 'B' || *end == 'b') end++;
+    if (*end != '\0' || v > (SIZE_MAX >> shift)) return -1;
+    *out = (size_t)v << shift;
+    return 0;
+}
+
+// Parse one --name[=value] option into opts; returns 0 on success
+static int parse_option(const char *arg) {
+    const char *val = strchr(arg, '=');
+    size_t len = val ? (size_t)(val - arg) : strlen(arg);
+    if (val) val++;
+
+#define OPT_IS(name) (len == strlen(name) && strncmp(arg, name, len) == 0)
+#define NEED_VALUE() do { if (!val || !*val) { \
+        fprintf(stderr, "Error: %.*s requires a value\n", (int)len, arg); return -1; } } while (0)
+
+    if (OPT_IS("--mode")) {
+        NEED_VALUE();
+        if (strcmp(val, "bench") == 0) opts.mode = MODE_BENCH;
+        else if (strcmp(val, "iouring") == 0) opts.mode = MODE_IOURING;
+        else if (strcmp(val, "ipc") == 0) opts.mode = MODE_IPC;
+        else if (strcmp(val, "ring") == 0) opts.mode = MODE_RING;
+        else if (strcmp(val, "pvm") == 0) opts.mode = MODE_PVM;
+        else if (strcmp(val, "magicring") == 0) opts.mode = MODE_MAGICRING;
+        else if (strcmp(val, "thread-sweep") == 0) opts.mode = MODE_THREAD_SWEEP;
+        else if (strcmp(val, "size-sweep") == 0) opts.mode = MODE_SIZE_SWEEP;
+        else if (strcmp(val, "smt") == 0) opts.mode = MODE_SMT;
+        else if (strcmp(val, "hybrid") == 0) opts.mode = MODE_HYBRID;
+        else if (strcmp(val, "schedule") == 0) opts.mode = MODE_SCHEDULE;
+        else if (strcmp(val, "forkjoin") == 0) opts.mode = MODE_FORKJOIN;
+        else if (strcmp(val, "l3domains") == 0) opts.mode = MODE_L3DOMAINS;
+        else if (strcmp(val, "interfere") == 0) opts.mode = MODE_INTERFERE;
+        else if (strcmp(val, "loadgen") == 0) opts.mode = MODE_LOADGEN;
+        else if (strcmp(val, "lownoise") == 0) opts.mode = MODE_LOWNOISE;
+        else {
+            fprintf(stderr, "Error: Unknown mode '%s'\n", val);
+            return -1;
+        }
+    } else if (OPT_IS("--file")) {
+        NEED_VALUE();
+        opts.file = val;
+    } else if (OPT_IS("--qd")) {
+        NEED_VALUE();
+        opts.queue_depth = atoi(val);
+        if (opts.queue_depth < 1 || opts.queue_depth > 4096) {
+            fprintf(stderr, "Error: --qd must be between 1 and 4096\n");
+            return -1;
+        }
+    } else if (OPT_IS("--bs")) {
+        NEED_VALUE();
+        size_t bs;
+        if (parse_size(val, &bs) != 0 || bs < 4096 || bs > (64UL << 20) || (bs & (bs - 1))) {
+            fprintf(stderr, "Error: --bs must be a power of two between 4K and 64M\n");
+            return -1;
+        }
+        opts.block_size = bs;
+    } else if (OPT_IS("--fixed")) {
+        opts.fixed_buffers = 1;
+    } else if (OPT_IS("--pipeline")) {
+        opts.pipeline = 1;
+    } else if (OPT_IS("--ring")) {
+        NEED_VALUE();
+        if (strcmp(val, "spsc") == 0) opts.ring_kind = RING_SPSC;
+        else if (strcmp(val, "mpmc") == 0) opts.ring_kind = RING_MPMC;
+        else if (strcmp(val, "both") == 0) opts.ring_kind = RING_BOTH;
+        else {
+            fprintf(stderr, "Error: --ring must be spsc, mpmc or both\n");
+            return -1;
+        }
+    } else if (OPT_IS("--procs")) {
+        opts.ring_procs = 1;
+    } else if (OPT_IS("--bind")) {
+        NEED_VALUE();
+        if (strcmp(val, "none") == 0) opts.bind = BIND_NONE;
+        else if (strcmp(val, "compact") == 0) opts.bind = BIND_COMPACT;
+        else if (strcmp(val, "scatter") == 0) opts.bind = BIND_SCATTER;
+        else if (strcmp(val, "core") == 0) opts.bind = BIND_CORE;
+        else if (val[0] >= '0' && val[0] <= '9') {
+            opts.bind = BIND_LIST;
+            opts.bind_list = val;
+        } else {
+            fprintf(stderr, "Error: --bind must be none, compact, scatter, core or a CPU list\n");
+            return -1;
+        }
+#ifndef __linux__
+        if (opts.bind != BIND_NONE) {
+            fprintf(stderr, "Error: --bind requires Linux\n");
+            return -1;
+        }
+#endif
+    } else if (OPT_IS("--patterns")) {
+        NEED_VALUE();
+        int r[MAX_PATTERNS], w[MAX_PATTERNS];
+        if (parse_patterns(val, r, w, MAX_PATTERNS) <= 0) {
+            fprintf(stderr, "Error: Invalid --patterns '%s' (e.g. 1:1,2:1,1:0)\n", val);
+            return -1;
+        }
+        opts.patterns = val;
+    } else if (OPT_IS("--probe-cache")) {
+        opts.probe_cache = 1;
+    } else if (OPT_IS("--auto-size")) {
+        NEED_VALUE();
+        if (strcmp(val, "detected") == 0) opts.auto_empirical = 0;
+        else if (strcmp(val, "empirical") == 0) opts.auto_empirical = 1;
+        else {
+            fprintf(stderr, "Error: --auto-size must be detected or empirical\n");
+            return -1;
+        }
+    } else if (OPT_IS("--csv")) {
+        NEED_VALUE();
+        opts.csv = val;
+    } else if (OPT_IS("--victim")) {
+        NEED_VALUE();
+        int r[MAX_PATTERNS], w[MAX_PATTERNS];
+        if (parse_victims(val, r, w, MAX_PATTERNS) <= 0) {
+            fprintf(stderr, "Error: --victim must be a list of reads:writes or latency\n");
+            return -1;
+        }
+        opts.victim = val;
+    } else if (OPT_IS("--rate")) {
+        NEED_VALUE();
+        char *end;
+        opts.rate_gbs = strtod(val, &end);
+        if (end == val || *end || opts.rate_gbs < 0) {
+            fprintf(stderr, "Error: --rate must be a bandwidth in GB/s (0 = unlimited)\n");
+            return -1;
+        }
+    } else if (OPT_IS("--duration")) {
+        NEED_VALUE();
+        char *end;
+        opts.duration = strtod(val, &end);
+        if (end == val || *end || opts.duration < 1 || opts.duration > 86400) {
+            fprintf(stderr, "Error: --duration must be between 1 and 86400 seconds\n");
+            return -1;
+        }
+    } else if (OPT_IS("--steps")) {
+        NEED_VALUE();
+        if (strcmp(val, "linear") == 0) opts.sweep_linear = 1;
+        else if (strcmp(val, "pow2") == 0) opts.sweep_linear = 0;
+        else {
+            fprintf(stderr, "Error: --steps must be pow2 or linear\n");
+            return -1;
+        }
+    } else if (OPT_IS("--schedule")) {
+        NEED_VALUE();
+        const char *chunk = strchr(val, ':');
+        size_t klen = chunk ? (size_t)(chunk - val) : strlen(val);
+        if (klen == 6 && strncmp(val, "static", 6) == 0) opts.schedule = SCHED_STATIC;
+        else if (klen == 7 && strncmp(val, "dynamic", 7) == 0) opts.schedule = SCHED_DYNAMIC;
+        else if (klen == 6 && strncmp(val, "guided", 6) == 0) opts.schedule = SCHED_GUIDED;
+        else if (klen == 5 && strncmp(val, "steal", 5) == 0) opts.schedule = SCHED_STEAL;
+        else {
+            fprintf(stderr, "Error: --schedule must be static, dynamic, guided or steal\n");
+            return -1;
+        }
+        if (chunk) {
+            chunk++;
+            if (strcmp(chunk, "line") == 0) opts.chunk_bytes = 64;
+            else if (strcmp(chunk, "page") == 0) opts.chunk_bytes = 4096;
+            else if (parse_size(chunk, &opts.chunk_bytes) != 0 || opts.chunk_bytes < 64 ||
+                     opts.chunk_bytes % 64 != 0) {
+                fprintf(stderr, "Error: chunk must be line, page or a multiple of 64 bytes\n");
+                return -1;
+            }
+        }
+    } else if (OPT_IS("--per-thread")) {
+        opts.per_thread = 1;
+    } else if (OPT_IS("--noise")) {
+        opts.noise = 1;
+    } else if (OPT_IS("--timer")) {
+        NEED_VALUE();
+        if (strcmp(val, "clock") == 0) opts.timer = TIMER_CLOCK;
+        else if (strcmp(val, "tsc") == 0) opts.timer = TIMER_TSC;
+        else {
+            fprintf(stderr, "Error: --timer must be clock or tsc\n");
+            return -1;
+        }
+    } else if (OPT_IS("--force")) {
+        opts.force = 1;
+    } else if (OPT_IS("--iters")) {
+        NEED_VALUE();
+        opts.iters = atoi(val);
+        if (opts.iters < 2 || opts.iters > 1000000) {
+            fprintf(stderr, "Error: --iters must be between 2 and 1000000\n");
+            return -1;
+        }
+    } else if (OPT_IS("--adaptive")) {
+        char *end;
+        opts.adaptive_ci = val ? strtod(val, &end) / 100.0 : 0.01;
+        if ((val && (end == val || *end)) || opts.adaptive_ci <= 0.0 || opts.adaptive_ci >= 1.0) {
+            fprintf(stderr, "Error: --adaptive must be a CI target in percent, e.g. --adaptive=0.5\n");
+            return -1;
+        }
+    } else if (OPT_IS("--budget")) {
+        NEED_VALUE();
+        char *end;
+        opts.budget = strtod(val, &end);
+        if (end == val || *end || opts.budget <= 0.0) {
+            fprintf(stderr, "Error: --budget must be a positive number of seconds\n");
+            return -1;
+        }
+    } else if (OPT_IS("--backend")) {
+        NEED_VALUE();
+        if (strcmp(val, "omp") == 0) opts.backend = BACKEND_OMP;
+        else if (strcmp(val, "pthread") == 0) opts.backend = BACKEND_PTHREAD;
+        else {
+            fprintf(stderr, "Error: --backend must be omp or pthread\n");
+            return -1;
+        }
+#ifndef __linux__
+        if (opts.backend == BACKEND_PTHREAD) {
+            fprintf(stderr, "Error: --backend=pthread requires Linux\n");
+            return -1;
+        }
+#endif
+    } else {
+        fprintf(stderr, "Error: Unknown option '%s'\n", arg);
+        return -1;
+    }
+
+#undef NEED_VALUE
+#undef OPT_IS
+    return 0;
 }
 
 int main(int argc, char *argv[]) {
-    if (argc < 3) {
+    // Options may appear anywhere; the rest are positional arguments
+    const char *pos[3] = {NULL, NULL, NULL};
+    int npos = 0;
+    for (int i = 1; i < argc; i++) {
+        if (strncmp(argv[i], "--", 2) == 0) {
+            if (parse_option(argv[i]) != 0) return 1;
+        } else if (npos < 3) {
+            pos[npos++] = argv[i];
+        } else {
+            fprintf(stderr, "Error: Unexpected argument '%s'\n", argv[i]);
+            return 1;
+        }
+    }
+    
+    if (npos < 2) {
         print_usage(argv[0]);
         return 1;
     }
     
-    int num_threads = atoi(argv[1]);
+    int num_threads = atoi(pos[0]);
     if (num_threads <= 0 || num_threads > 1024) {
         fprintf(stderr, "Error: num_threads must be between 1 and 1024\n");
         return 1;
@@ -548,8 +5904,8 @@ int main(int argc, char *argv[]) {
     
     // Parse reads:writes pattern
     int reads = 0, writes = 0;
-    if (sscanf(argv[2], "%d:%d", &reads, &writes) != 2) {
-        fprintf(stderr, "Error: Invalid pattern '%s'. Use format reads:writes (e.g., 1:1, 2:1)\n", argv[2]);
+    if (sscanf(pos[1], "%d:%d", &reads, &writes) != 2) {
+        fprintf(stderr, "Error: Invalid pattern '%s'. Use format reads:writes (e.g., 1:1, 2:1)\n", pos[1]);
         return 1;
     }
     if (reads < 0 || reads > 100 || writes < 0 || writes > 100) {
@@ -561,6 +5917,30 @@ int main(int argc, char *argv[]) {
         return 1;
     }
     
+    // The duration series times whole OpenMP passes; it has no pool, no
+    // per-thread samples and no noise snapshots to report
+    if (opts.mode == MODE_BENCH && opts.duration > 0) {
+        const char *unsupported = opts.backend == BACKEND_PTHREAD ? "--backend=pthread"
+                                : opts.per_thread ? "--per-thread"
+                                : opts.noise ? "--noise" : NULL;
+        if (unsupported) {
+            fprintf(stderr, "Error: %s cannot be combined with --duration\n", unsupported);
+            return 1;
+        }
+    }
+    
+    // The pool and the per-thread timer run fixed static slices
+    if (opts.mode == MODE_BENCH && opts.schedule != SCHED_STATIC) {
+        const char *unsupported = opts.backend == BACKEND_PTHREAD ? "--backend=pthread"
+                                : opts.per_thread ? "--per-thread" : NULL;
+        if (unsupported) {
+            fprintf(stderr, "Error: %s requires --schedule=static\n", unsupported);
+            return 1;
+        }
+    }
+    
+    if (timer_init() != 0) return 1;
+    
     // Detect cache info
     cache_info_t cache = detect_cache_info();
     
@@ -588,25 +5968,73 @@ int main(int argc, char *argv[]) {
     // Print detected cache info
     print_cache_info(&cache);
     
+    if (opts.probe_cache || opts.auto_empirical) {
+        cache_probe_t probe;
+        probe_cache(&cache, num_threads, &probe);
+        print_cache_probe(&cache, &probe);
+        if (opts.auto_empirical) apply_cache_probe(&cache, &probe);
+    }
+    
     // Calculate array size
-    size_t array_mb;
-    if (argc >= 4) {
-        array_mb = atol(argv[3]);
-        if (array_mb < 1 || array_mb > 65536) {
-            fprintf(stderr, "Error: array_size_mb must be between 1 and 65536\n");
+    size_t array_bytes;
+    if (npos >= 3) {
+        // A bare number is MB; with a K/M/G suffix it is bytes, down to cache sizes
+        if (parse_size(pos[2], &array_bytes) != 0) {
+            array_bytes = 0;
+        } else if (strspn(pos[2], "0123456789") == strlen(pos[2])) {
+            array_bytes = array_bytes > (SIZE_MAX >> 20) ? 0 : array_bytes << 20;
+        }
+        if (array_bytes < 1024 || array_bytes > (64ULL << 30)) {
+            fprintf(stderr, "Error: array size must be between 1K and 64G (bare numbers are MB)\n");
             return 1;
         }
     } else {
         // Default: 4x L3 size to ensure we're testing DRAM, not cache
         // Minimum 128 MB per array
-        size_t l3_mb = cache.l3_size / (1024 * 1024);
-        array_mb = MAX(l3_mb * 4 / 3, 128);  // Divide by 3 because we have 3 arrays
+        size_t l3_mb = cache_l3_total(&cache) / (1024 * 1024);
+        size_t array_mb = MAX(l3_mb * 4 / 3, 128);  // Divide by 3 because we have 3 arrays
         printf("  Auto array size: %zu MB (4x L3 / 3 arrays)\n\n", array_mb);
+        array_bytes = array_mb << 20;
     }
     
-    size_t array_size = (array_mb * 1024 * 1024) / sizeof(double);
+    size_t array_size = array_bytes / sizeof(double);
     
-    run_benchmark(num_threads, array_size, &cache, reads, writes);
+    switch (opts.mode) {
+    case MODE_IOURING:
+        return run_iouring(num_threads, array_size);
+    case MODE_IPC:
+        return run_ipc(num_threads, array_size);
+    case MODE_RING:
+        return run_ring(num_threads, array_size);
+    case MODE_PVM:
+        return run_pvm(num_threads, array_size);
+    case MODE_MAGICRING:
+        return run_mring(array_size, &cache);
+    case MODE_THREAD_SWEEP:
+        return run_thread_sweep(num_threads, array_size, reads, writes);
+    case MODE_SIZE_SWEEP:
+        return run_size_sweep(num_threads, array_size, &cache, reads, writes);
+    case MODE_SMT:
+        return run_smt(num_threads, array_size, reads, writes);
+    case MODE_HYBRID:
+        return run_hybrid(num_threads, array_size, reads, writes);
+    case MODE_SCHEDULE:
+        return run_schedule(num_threads, array_size, reads, writes);
+    case MODE_FORKJOIN:
+        return run_forkjoin(num_threads);
+    case MODE_L3DOMAINS:
+        return run_l3domains(num_threads, array_size, reads, writes);
+    case MODE_INTERFERE:
+        return run_interfere(num_threads, array_size, reads, writes);
+    case MODE_LOADGEN:
+        return run_loadgen(num_threads, array_size, reads, writes);
+    case MODE_LOWNOISE:
+        return run_lownoise(num_threads, array_size, reads, writes);
+    case MODE_BENCH:
+    default:
+        if (opts.duration > 0) return run_duration(num_threads, array_size, reads, writes);
+        return run_benchmark(num_threads, array_size, &cache, reads, writes);
+    }
     
     return 0;
 }